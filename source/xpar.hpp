@@ -6,21 +6,38 @@
 
 #pragma once
 #ifndef PCH
+    #include <algorithm>
     #include <array>
+    #include <cctype>
+    #include <cstdint>
     #include <cstring>
+    #include <iterator>
+    #include <type_traits>
+    #if defined(__SSE2__)
+        #include <emmintrin.h>
+    #endif
 #endif
 
 namespace stdext
 {
-    /*class observer_example
+    /*class observer_example // every callback is optional, see xpar_observer_traits
     {
     public:
         void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        // lazy_attributes only, preferred to the one above
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end, const xpar_attributes<char_t>& attributes);
         void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
         void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end);
         void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_start_tag_end(xpar_t& parser, const bool empty); // after the last attribute of a start tag
+        // replaces on_element_begin, on_attribute and on_attribute_value, needs max_attributes != 0
+        void on_start_tag(xpar_t& parser, const char_t* name, const char_t* name_end, const attribute_t* attributes,
+                          const attribute_t* attributes_end);
+        // xpar_hash of the element and attribute names, the other attributes are skipped without a copy or a callback
+        bool wanted_attribute(const xpar_t& parser, const std::uint32_t element, const std::uint32_t attribute);
         void on_data(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
         void on_comment(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_cdata(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial); // on_data when missing
         void on_error(xpar_t& parser, bool& try_continue);
     };*/
 
@@ -33,10 +50,565 @@ namespace stdext
             try_continue_on_error = 0,
             max_name_length = 32,
             max_value_length = 512,
-            max_stack_size = 16
+            max_stack_size = 16,
+            track_position = 1,
+            error_recovery = 1,
+            report_comments = 1,
+            doctype = 1,
+            check_limits = 1,
+            computed_goto = 0,
+            trim_text = 0,
+            decode_references = 0,
+            max_attributes = 0,
+            lazy_attributes = 0
         };
     };
 
+    /// FNV-1a hash of a name, one step per character; usable as case label, e.g. case xpar_hash("id"):
+    template <typename _Char>
+    constexpr std::uint32_t xpar_hash(const _Char* text, const _Char* text_end) noexcept
+    {
+        std::uint32_t result = 2166136261U;
+        for (; text != text_end; ++text)
+            result = (result ^ static_cast<typename std::make_unsigned<_Char>::type>(*text)) * 16777619U;
+        return result;
+    }
+
+    constexpr std::uint32_t xpar_hash(const char* text) noexcept
+    {
+        const char* text_end = text;
+        while (*text_end)
+            ++text_end;
+        return xpar_hash(text, text_end);
+    }
+
+    /// An attribute of a start tag reported by on_start_tag, value is nullptr when the attribute has none.
+    template <typename _Char>
+    struct xpar_attribute
+    {
+        const _Char* name;
+        const _Char* name_end;
+        const _Char* value;
+        const _Char* value_end;
+    };
+
+    template <typename _Char>
+    class xpar_attributes;
+
+    namespace xpar_detail
+    {
+        template <typename...>
+        struct make_void
+        {
+            using type = void;
+        };
+
+        template <typename... _Types>
+        using void_t = typename make_void<_Types...>::type;
+
+#define XPAR_OPTION(name, default_value)                                                                    \
+    template <typename _Config, typename = void>                                                            \
+    struct name: std::integral_constant<bool, default_value>                                                \
+    {                                                                                                       \
+    };                                                                                                      \
+                                                                                                            \
+    template <typename _Config>                                                                             \
+    struct name<_Config, void_t<decltype(_Config::name)>>: std::integral_constant<bool, _Config::name != 0> \
+    {                                                                                                       \
+    };
+
+        XPAR_OPTION(track_position, true)
+        XPAR_OPTION(error_recovery, true)
+        XPAR_OPTION(report_comments, true)
+        XPAR_OPTION(doctype, true)
+        XPAR_OPTION(check_limits, true)
+        XPAR_OPTION(computed_goto, false)
+        XPAR_OPTION(trim_text, false)
+        XPAR_OPTION(decode_references, false)
+        XPAR_OPTION(lazy_attributes, false)
+#undef XPAR_OPTION
+
+        template <typename _Config, typename = void>
+        struct max_attributes: std::integral_constant<std::size_t, 0U>
+        {
+        };
+
+        template <typename _Config>
+        struct max_attributes<_Config, void_t<decltype(_Config::max_attributes)>>:
+            std::integral_constant<std::size_t, static_cast<std::size_t>(_Config::max_attributes)>
+        {
+        };
+
+#define XPAR_CALLBACK(name, ...)                                                                                                 \
+    template <typename _Observer, typename _Parser, typename = void>                                                           \
+    struct name: std::false_type                                                                                               \
+    {                                                                                                                          \
+    };                                                                                                                         \
+                                                                                                                               \
+    template <typename _Observer, typename _Parser>                                                                            \
+    struct name<_Observer, _Parser, void_t<decltype(std::declval<_Observer&>().name(std::declval<_Parser&>(), __VA_ARGS__))>>: \
+        std::true_type                                                                                                         \
+    {                                                                                                                          \
+    };
+
+#define XPAR_TEXT std::declval<const typename _Parser::char_t*>()
+#define XPAR_ATTRIBUTES std::declval<const xpar_attribute<typename _Parser::char_t>*>()
+
+        XPAR_CALLBACK(on_element_begin, XPAR_TEXT, XPAR_TEXT)
+        XPAR_CALLBACK(on_element_end, XPAR_TEXT, XPAR_TEXT)
+        XPAR_CALLBACK(on_attribute, XPAR_TEXT, XPAR_TEXT)
+        XPAR_CALLBACK(on_attribute_value, XPAR_TEXT, XPAR_TEXT, false)
+        XPAR_CALLBACK(on_data, XPAR_TEXT, XPAR_TEXT, false)
+        XPAR_CALLBACK(on_comment, XPAR_TEXT, XPAR_TEXT, false)
+        XPAR_CALLBACK(on_cdata, XPAR_TEXT, XPAR_TEXT, false)
+        XPAR_CALLBACK(on_start_tag_end, false)
+        XPAR_CALLBACK(on_start_tag, XPAR_TEXT, XPAR_TEXT, XPAR_ATTRIBUTES, XPAR_ATTRIBUTES)
+        XPAR_CALLBACK(on_error, std::declval<bool&>())
+        XPAR_CALLBACK(wanted_attribute, std::uint32_t {}, std::uint32_t {})
+
+        template <typename _Observer, typename _Parser, typename = void>
+        struct on_element_begin_raw: std::false_type
+        {
+        };
+
+        template <typename _Observer, typename _Parser>
+        struct on_element_begin_raw<_Observer, _Parser,
+                                    void_t<decltype(std::declval<_Observer&>().on_element_begin(
+                                        std::declval<_Parser&>(), XPAR_TEXT, XPAR_TEXT,
+                                        std::declval<const xpar_attributes<typename _Parser::char_t>&>()))>>: std::true_type
+        {
+        };
+#undef XPAR_ATTRIBUTES
+#undef XPAR_TEXT
+#undef XPAR_CALLBACK
+
+        template <typename _Object, typename _Function>
+        void call_if(std::true_type, _Object& object, _Function function)
+        {
+            function(object);
+        }
+
+        template <typename _Object, typename _Function>
+        void call_if(std::false_type, _Object& /*object*/, _Function /*function*/)
+        {
+        }
+
+        template <typename _Char>
+        constexpr bool is_space(const _Char value) noexcept
+        {
+            return (value == ' ') || (value == '\n') || (value == '\t') || (value == '\r') || (value == '\v');
+        }
+
+        template <typename _Char>
+        std::size_t count(const _Char* begin, const _Char* end, const _Char value) noexcept
+        {
+            return static_cast<std::size_t>(std::count(begin, end, value));
+        }
+
+        template <typename _Char>
+        const _Char* find(const _Char* begin, const _Char* end, const _Char value) noexcept
+        {
+            return std::find(begin, end, value);
+        }
+
+        inline const char* find(const char* begin, const char* end, const char value) noexcept
+        {
+            const void* const result = std::memchr(begin, value, end - begin);
+            return result ? static_cast<const char*>(result) : end;
+        }
+
+        /// The first '>' or quote, the characters a start tag scan stops at.
+        template <typename _Char>
+        const _Char* find_tag_end(const _Char* begin, const _Char* end) noexcept
+        {
+            return std::find_if(begin, end, [](const _Char value) { return (value == '>') || (value == '"') || (value == '\''); });
+        }
+
+#if defined(__SSE2__)
+        inline std::size_t count(const char* begin, const char* end, const char value) noexcept
+        {
+            std::size_t result = 0U;
+            const __m128i pattern = _mm_set1_epi8(value);
+            for (; end - begin >= 16; begin += 16)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                result += static_cast<std::size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern))));
+            }
+
+            return result + static_cast<std::size_t>(std::count(begin, end, value));
+        }
+
+        inline const char* find_tag_end(const char* begin, const char* end) noexcept
+        {
+            const __m128i greater = _mm_set1_epi8('>');
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i apostrophe = _mm_set1_epi8('\'');
+            for (; end - begin >= 16; begin += 16)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, greater), _mm_cmpeq_epi8(block, quote)),
+                                                   _mm_cmpeq_epi8(block, apostrophe));
+                const int mask = _mm_movemask_epi8(found);
+                if (mask != 0)
+                    return begin + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+
+            return find_tag_end<char>(begin, end);
+        }
+
+        // the compare masks have one bit per byte, 2 or 4 per wide character
+        inline std::size_t count(const char16_t* begin, const char16_t* end, const char16_t value) noexcept
+        {
+            std::size_t result = 0U;
+            const __m128i pattern = _mm_set1_epi16(static_cast<short>(value));
+            for (; end - begin >= 8; begin += 8)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                result += static_cast<std::size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi16(block, pattern))) >> 1);
+            }
+
+            return result + static_cast<std::size_t>(std::count(begin, end, value));
+        }
+
+        inline std::size_t count(const char32_t* begin, const char32_t* end, const char32_t value) noexcept
+        {
+            std::size_t result = 0U;
+            const __m128i pattern = _mm_set1_epi32(static_cast<int>(value));
+            for (; end - begin >= 4; begin += 4)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                result += static_cast<std::size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi32(block, pattern))) >> 2);
+            }
+
+            return result + static_cast<std::size_t>(std::count(begin, end, value));
+        }
+
+        inline const char16_t* find(const char16_t* begin, const char16_t* end, const char16_t value) noexcept
+        {
+            const __m128i pattern = _mm_set1_epi16(static_cast<short>(value));
+            for (; end - begin >= 8; begin += 8)
+            {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), pattern));
+                if (mask != 0)
+                    return begin + (__builtin_ctz(static_cast<unsigned>(mask)) >> 1);
+            }
+
+            return std::find(begin, end, value);
+        }
+
+        inline const char32_t* find(const char32_t* begin, const char32_t* end, const char32_t value) noexcept
+        {
+            const __m128i pattern = _mm_set1_epi32(static_cast<int>(value));
+            for (; end - begin >= 4; begin += 4)
+            {
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), pattern));
+                if (mask != 0)
+                    return begin + (__builtin_ctz(static_cast<unsigned>(mask)) >> 2);
+            }
+
+            return std::find(begin, end, value);
+        }
+#endif
+
+        /// Name characters: ASCII letters, digits and "_:-.", non-ASCII characters are accepted as they are.
+        template <typename _Char>
+        constexpr bool is_name_start(const _Char value) noexcept
+        {
+            return ((value >= 'a') && (value <= 'z')) || ((value >= 'A') && (value <= 'Z')) || (value == '_') || (value == ':') ||
+                   (static_cast<typename std::make_unsigned<_Char>::type>(value) >= 0x80U);
+        }
+
+        template <typename _Char>
+        constexpr bool is_name_char(const _Char value) noexcept
+        {
+            return is_name_start(value) || ((value >= '0') && (value <= '9')) || (value == '-') || (value == '.');
+        }
+
+        enum
+        {
+            max_reference_length = 12 // "&#x0010FFFF;"
+        };
+
+        template <typename _Char>
+        _Char* encode(const std::uint32_t code, _Char* out) noexcept
+        {
+            if (sizeof(_Char) == 4U)
+                *out++ = static_cast<_Char>(code);
+            else if (sizeof(_Char) == 2U)
+            {
+                if (code >= 0x10000U)
+                {
+                    *out++ = static_cast<_Char>(0xD800U + ((code - 0x10000U) >> 10));
+                    *out++ = static_cast<_Char>(0xDC00U + ((code - 0x10000U) & 0x3FFU));
+                }
+                else
+                    *out++ = static_cast<_Char>(code);
+            }
+            else if (code < 0x80U)
+                *out++ = static_cast<_Char>(code);
+            else if (code < 0x800U)
+            {
+                *out++ = static_cast<_Char>(0xC0U | (code >> 6));
+                *out++ = static_cast<_Char>(0x80U | (code & 0x3FU));
+            }
+            else if (code < 0x10000U)
+            {
+                *out++ = static_cast<_Char>(0xE0U | (code >> 12));
+                *out++ = static_cast<_Char>(0x80U | ((code >> 6) & 0x3FU));
+                *out++ = static_cast<_Char>(0x80U | (code & 0x3FU));
+            }
+            else
+            {
+                *out++ = static_cast<_Char>(0xF0U | (code >> 18));
+                *out++ = static_cast<_Char>(0x80U | ((code >> 12) & 0x3FU));
+                *out++ = static_cast<_Char>(0x80U | ((code >> 6) & 0x3FU));
+                *out++ = static_cast<_Char>(0x80U | (code & 0x3FU));
+            }
+
+            return out;
+        }
+
+        template <typename _Char>
+        bool equal(const _Char* begin, const _Char* end, const char* text) noexcept
+        {
+            for (; (begin != end) && (*text != '\0'); ++begin, ++text)
+                if (*begin != static_cast<_Char>(*text))
+                    return false;
+
+            return (begin == end) && (*text == '\0');
+        }
+
+        /// Decodes the character or predefined entity reference starting with the '&' at in into out, never writing more than it reads.
+        /// Returns the reference end, nullptr when [in, end) may be the head of a reference or in when it is not a reference.
+        template <typename _Char>
+        const _Char* decode_reference(const _Char* in, const _Char* end, _Char*& out) noexcept
+        {
+            const _Char* semicolon = in + 1;
+            for (; (semicolon != end) && (*semicolon != ';'); ++semicolon)
+            {
+                const _Char value = *semicolon;
+                const bool name_char = ((value >= '0') && (value <= '9')) || ((value >= 'a') && (value <= 'z')) ||
+                                       ((value >= 'A') && (value <= 'Z')) || (value == '#');
+                if ((semicolon - in == max_reference_length - 1) || !name_char)
+                    return in;
+            }
+
+            if (semicolon == end)
+                return nullptr;
+
+            std::uint32_t code = 0U;
+            const _Char* name = in + 1;
+            if ((name != semicolon) && (*name == '#'))
+            {
+                const bool hex = (semicolon - name > 1) && ((name[1] == 'x') || (name[1] == 'X'));
+                const _Char* digit = name + (hex ? 2 : 1);
+                if (digit == semicolon)
+                    return in;
+
+                for (; digit != semicolon; ++digit)
+                {
+                    const _Char value = *digit;
+                    std::uint32_t number;
+                    if ((value >= '0') && (value <= '9'))
+                        number = static_cast<std::uint32_t>(value - '0');
+                    else if (hex && (value >= 'a') && (value <= 'f'))
+                        number = static_cast<std::uint32_t>(value - 'a' + 10);
+                    else if (hex && (value >= 'A') && (value <= 'F'))
+                        number = static_cast<std::uint32_t>(value - 'A' + 10);
+                    else
+                        return in;
+
+                    code = code * (hex ? 16U : 10U) + number;
+                    if (code > 0x10FFFFU)
+                        return in;
+                }
+
+                if ((code == 0U) || ((code >= 0xD800U) && (code <= 0xDFFFU)))
+                    return in;
+            }
+            else if (equal(name, semicolon, "lt"))
+                code = '<';
+            else if (equal(name, semicolon, "gt"))
+                code = '>';
+            else if (equal(name, semicolon, "amp"))
+                code = '&';
+            else if (equal(name, semicolon, "quot"))
+                code = '"';
+            else if (equal(name, semicolon, "apos"))
+                code = '\'';
+            else
+                return in;
+
+            out = encode(code, out);
+            return semicolon + 1;
+        }
+
+        /// Decodes the references in place, returns the new end; unknown and malformed references are left as they are.
+        template <typename _Char>
+        _Char* decode_in_place(_Char* begin, _Char* end) noexcept
+        {
+            _Char* out = const_cast<_Char*>(find(static_cast<const _Char*>(begin), static_cast<const _Char*>(end), _Char('&')));
+            for (const _Char* in = out; in != end;)
+            {
+                if (*in == '&')
+                {
+                    const _Char* const reference_end = decode_reference(in, static_cast<const _Char*>(end), out);
+                    if (reference_end && (reference_end != in))
+                    {
+                        in = reference_end;
+                        continue;
+                    }
+                }
+
+                *out++ = *in++;
+            }
+
+            return out;
+        }
+
+    }
+
+    /// The attributes of a start tag as written, see lazy_attributes; they are parsed while iterated and the values are not decoded.
+    /// The iteration stops at the first malformed attribute.
+    template <typename _Char>
+    class xpar_attributes
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = xpar_attribute<_Char>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = const value_type&;
+
+            iterator(const _Char* ptr, const _Char* end) noexcept: ptr_(ptr), end_(end) { next(); }
+
+            reference operator*() const noexcept { return attribute_; }
+            pointer operator->() const noexcept { return &attribute_; }
+            iterator& operator++() noexcept
+            {
+                next();
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                iterator result = *this;
+                next();
+                return result;
+            }
+
+            bool operator==(const iterator& other) const noexcept { return attribute_.name == other.attribute_.name; }
+            bool operator!=(const iterator& other) const noexcept { return attribute_.name != other.attribute_.name; }
+
+        private:
+            void next() noexcept;
+            void skip_space() noexcept
+            {
+                while ((ptr_ != end_) && xpar_detail::is_space(*ptr_))
+                    ++ptr_;
+            }
+
+            const _Char* ptr_;
+            const _Char* end_;
+            xpar_attribute<_Char> attribute_ {};
+        };
+
+        constexpr xpar_attributes(const _Char* text, const _Char* text_end) noexcept: text_(text), text_end_(text_end) {}
+
+        iterator begin() const noexcept { return {text_, text_end_}; }
+        iterator end() const noexcept { return {text_end_, text_end_}; }
+        const _Char* text() const noexcept { return text_; }
+        const _Char* text_end() const noexcept { return text_end_; }
+
+    private:
+        const _Char* text_;
+        const _Char* text_end_;
+    };
+
+    template <typename _Char>
+    void xpar_attributes<_Char>::iterator::next() noexcept
+    {
+        attribute_ = {};
+        skip_space();
+        const _Char* const name = ptr_;
+        while ((ptr_ != end_) && xpar_detail::is_name_char(*ptr_))
+            ++ptr_;
+        const _Char* const name_end = ptr_;
+        skip_space();
+        if ((name == name_end) || (ptr_ == end_) || (*ptr_ != '='))
+        {
+            ptr_ = end_;
+            return;
+        }
+
+        ++ptr_;
+        skip_space();
+        if ((ptr_ == end_) || ((*ptr_ != '"') && (*ptr_ != '\'')))
+        {
+            ptr_ = end_;
+            return;
+        }
+
+        const _Char quote = *ptr_++;
+        const _Char* const value_end = xpar_detail::find(ptr_, end_, quote);
+        if (value_end == end_)
+            return;
+
+        attribute_ = {name, name_end, ptr_, value_end};
+        ptr_ = value_end + 1;
+    }
+
+    /// Optional _Config constants and their defaults:
+    ///     track_position (1): line and column bookkeeping while parsing; when 0 they are computed on request from the current buffer.
+    ///     error_recovery (1): on_error may ask to continue; when 0 parsing always stops at the first error.
+    ///     report_comments (1): comments are reported through on_comment; when 0 they are skipped.
+    ///     doctype (1): DOCTYPE declarations are skipped; when 0 they are reported as unexpected_char errors.
+    ///     check_limits (1): names, values and the element depth are checked against the limits; when 0 the input must respect them.
+    ///     computed_goto (0): GCC/Clang only, operator() dispatches the states through a label table instead of a switch.
+    ///     trim_text (0): on_data gets the text without its trailing whitespace; whitespace only text is never reported.
+    ///     decode_references (0): character references and the predefined entities are decoded in text and attribute values,
+    ///         unknown or malformed ones are passed as they are; text without references is still reported from the input buffer.
+    ///     max_attributes (0): capacity of on_start_tag, which needs it; the start tag buffers take no space when 0.
+    ///     lazy_attributes (0): a start tag is scanned for its end only, on_element_begin may take the attributes as xpar_attributes
+    ///         and parse them on demand; on_attribute, on_attribute_value, on_start_tag and wanted_attribute are not used.
+    ///         A start tag split by a buffer end is copied, its attributes may then take up to max_value_length characters.
+    template <typename _Config>
+    struct xpar_options
+    {
+        static constexpr bool track_position = xpar_detail::track_position<_Config>::value;
+        static constexpr bool error_recovery = xpar_detail::error_recovery<_Config>::value;
+        static constexpr bool report_comments = xpar_detail::report_comments<_Config>::value;
+        static constexpr bool doctype = xpar_detail::doctype<_Config>::value;
+        static constexpr bool check_limits = xpar_detail::check_limits<_Config>::value;
+        static constexpr bool computed_goto = xpar_detail::computed_goto<_Config>::value;
+        static constexpr bool trim_text = xpar_detail::trim_text<_Config>::value;
+        static constexpr bool decode_references = xpar_detail::decode_references<_Config>::value;
+        static constexpr std::size_t max_attributes = xpar_detail::max_attributes<_Config>::value;
+        static constexpr bool lazy_attributes = xpar_detail::lazy_attributes<_Config>::value;
+    };
+
+    /// Callbacks the observer provides; xpar skips the work behind the missing ones, e.g. attribute values
+    /// are not copied when there is no on_attribute_value.
+    template <typename _Observer, typename _Parser>
+    struct xpar_observer_traits
+    {
+        using on_element_begin = xpar_detail::on_element_begin<_Observer, _Parser>;
+        using on_element_end = xpar_detail::on_element_end<_Observer, _Parser>;
+        using on_attribute = xpar_detail::on_attribute<_Observer, _Parser>;
+        using on_attribute_value = xpar_detail::on_attribute_value<_Observer, _Parser>;
+        using on_data = xpar_detail::on_data<_Observer, _Parser>;
+        using on_comment = xpar_detail::on_comment<_Observer, _Parser>;
+        using on_cdata = xpar_detail::on_cdata<_Observer, _Parser>;
+        using on_start_tag_end = xpar_detail::on_start_tag_end<_Observer, _Parser>;
+        using on_start_tag = xpar_detail::on_start_tag<_Observer, _Parser>;
+        using wanted_attribute = xpar_detail::wanted_attribute<_Observer, _Parser>;
+        using on_element_begin_raw = xpar_detail::on_element_begin_raw<_Observer, _Parser>;
+        using on_error = xpar_detail::on_error<_Observer, _Parser>;
+    };
+
     template <typename _Observer, typename _Config = xpar_default_config>
     class xpar
     {
@@ -45,6 +617,9 @@ namespace stdext
         using config_t = _Config;
         using char_t = typename _Config::char_t;
         using observer_t = _Observer;
+        using options_t = xpar_options<_Config>;
+        using traits_t = xpar_observer_traits<_Observer, xpar>;
+        using attribute_t = xpar_attribute<char_t>;
 
         enum class error_t
         {
@@ -55,15 +630,30 @@ namespace stdext
             max_elem_name_length_exceeded,
             max_attr_name_length_exceeded,
             max_attr_value_length_exceeded,
+            max_attr_count_exceeded,
+            max_stack_size_exceeded, // more than max_stack_size - 1 open elements, parsing stops
+        };
+
+        enum constant
+        {
+            checkpoint_version = 3,
+            checkpoint_header_size = 36,
+            max_checkpoint_size = checkpoint_header_size + sizeof(std::uint16_t) * config_t::max_stack_size +
+                                  sizeof(char_t) * (1U + config_t::max_value_length + config_t::max_stack_size * config_t::max_name_length),
         };
 
         constexpr xpar(observer_t* const observer) noexcept: observer_(observer) {}
 
         void operator()(const char_t* buffer, const std::size_t buffer_size);
 
-        uint_t line() const noexcept { return line_; }
-        uint_t column() const noexcept { return static_cast<uint_t>(1U + item_begin_ - line_begin_); }
+        uint_t line() const noexcept;
+        uint_t column() const noexcept;
         error_t error() const noexcept { return error_; }
+        const char_t* position() const noexcept { return ptr_; }
+        const char_t* item_begin() const noexcept { return item_begin_; }
+        std::uint64_t offset() const noexcept { return base_offset_ + static_cast<std::uint64_t>(ptr_ - begin_); }
+        /// The offset of the '<' of the element reported by on_element_begin.
+        std::uint64_t tag_offset() const noexcept;
 
         uint_t stack_size() const noexcept;
         const char_t* stack_value(const uint_t index) const noexcept;
@@ -73,6 +663,22 @@ namespace stdext
 
         void reset() noexcept;
 
+        /// Serializes the parser state between two buffers into at most max_checkpoint_size bytes, returns the size or 0 if it does not
+        /// fit, a reference split by the buffer end is pending or a start tag is being collected for on_start_tag.
+        /// A parser restored from it continues with the input following offset(); the column is counted from the resume point.
+        /// The format is in native byte order. restore() rejects another version, byte order or character size, and limits larger
+        /// than the config's.
+        std::size_t checkpoint(void* const buffer, const std::size_t buffer_size) const noexcept;
+        bool restore(const void* const data, const std::size_t size) noexcept;
+
+        /// Resets the parser to continue with the input at the given offset and line, outside any element.
+        void seek(const std::uint64_t offset, const uint_t line) noexcept;
+        /// Opens an element without reporting it, used to rebuild the context of a seek position.
+        bool push_element(const char_t* name, const char_t* name_end) noexcept;
+        /// Called while a start tag is reported, skips the element content: only on_element_end of the element follows.
+        /// The content is scanned for the matching end tag without being checked.
+        void skip_element() noexcept { skip_requested_ = true; }
+
     protected:
         enum class result_t
         {
@@ -96,10 +702,40 @@ namespace stdext
             meta,
             dtd,
             single_elem_end,
+            markup,
+            cdata_open,
+            cdata,
+            start_tag,
+            skip,
+        };
+
+        // the construct skip() is in
+        enum class skip_t
+        {
+            text,
+            open,
+            markup,
+            start_tag,
+            tag_end,
+            comment,
+            cdata,
+            pi,
         };
 
         using value_buffer_t = std::array<char_t, config_t::max_value_length>;
         using stack_buffer_t = std::array<char_t, config_t::max_stack_size * config_t::max_name_length>;
+        using scratch_buffer_t =
+            std::array<char_t, options_t::decode_references ? static_cast<std::size_t>(config_t::max_value_length) : 1U>;
+        using reference_buffer_t =
+            std::array<char_t, options_t::decode_references ? static_cast<std::size_t>(xpar_detail::max_reference_length) : 1U>;
+        // on_start_tag collects the whole start tag: the attribute names and values are read one after the other into tag_buffer_;
+        // the name of an attribute over max_attributes is read before it is dropped, hence one more name. The sizes come from the
+        // config, the observer is still incomplete here
+        static constexpr std::size_t tag_buffer_size =
+            config_t::max_name_length + options_t::max_attributes * (config_t::max_name_length + config_t::max_value_length) +
+            config_t::max_name_length;
+        using tag_buffer_t = std::array<char_t, options_t::max_attributes ? tag_buffer_size : 1U>;
+        using attribute_buffer_t = std::array<attribute_t, options_t::max_attributes ? options_t::max_attributes : 1U>;
 
         bool space() noexcept;
         result_t identifier() noexcept;
@@ -119,50 +755,82 @@ namespace stdext
         void single_elem_end();
         void attr_value_continue();
         void data_continue();
+        void trimmed_data(const char_t* text, const bool partial);
+        void report_data(const char_t* text, const char_t* text_end, const bool partial);
         void comment();
         void meta();
         void dtd();
+        void markup();
+        void cdata_open();
+        void cdata();
+        void report_cdata(const char_t* text, const char_t* text_end, const bool partial);
+        void report_start_tag(const bool empty);
+        void start_tag();
+        void skip();
+        void count_lines(const char_t* text) noexcept;
+        bool attribute_wanted();
+        void new_line() noexcept;
+#if defined(__GNUC__)
+        using dispatch_t = std::integral_constant<bool, options_t::computed_goto>;
+        void dispatch(std::true_type);
+#else
+        using dispatch_t = std::false_type;
+#endif
+        void dispatch(std::false_type);
+        const char_t* last_line_begin() const noexcept;
+        void fold_lines() const noexcept;
         bool try_continue_handling_error(const error_t error);
 
         stack_buffer_t stack_buffer_ {};
         value_buffer_t value_buffer_ {};
+        scratch_buffer_t scratch_buffer_ {};
+        reference_buffer_t reference_buffer_ {};
+        tag_buffer_t tag_buffer_ {};
+        attribute_buffer_t attributes_ {};
         const char_t* ptr_ {};
+        const char_t* begin_ {};
         const char_t* end_ {};
         const char_t* line_begin_ {};
         const char_t* item_begin_ {};
+        mutable const char_t* count_begin_ {};
         char_t* id_ {value_buffer_.data()};
         char_t* id_end_ {value_buffer_.data()};
         char_t* stack_pointer_ {stack_buffer_.data()};
+        const char_t* tag_name_end_ {};
+        attribute_t* pending_attribute_ {};
         observer_t* observer_;
-        uint_t line_ {1U};
+        std::uint64_t base_offset_ {};
+        std::uint64_t tag_offset_ {}; // lazy_attributes only, on_element_begin comes at the end of the tag
+        mutable uint_t line_ {1U};
+        uint_t counter_ {};
+        mutable uint_t column_base_ {};
+        uint_t reference_size_ {};
+        uint_t attribute_count_ {};
+        std::uint32_t element_hash_ {};
         state_t state_ {};
         error_t error_ {};
         char_t last_delimiter_ {};
         bool item_read_ {};
+        bool skip_value_ {};
+        bool skip_requested_ {};
+        skip_t skip_ {};
+        uint_t skip_match_ {};
     };
 
     template <typename _Observer, typename _Config>
     typename xpar<_Observer, _Config>::result_t xpar<_Observer, _Config>::identifier() noexcept
     {
-        item_begin_ = ptr_;
+        if (options_t::track_position)
+            item_begin_ = ptr_;
         for (std::size_t len = id_end_ - id_;;)
         {
             if (ptr_ == end_) [[unlikely]]
                 return result_t::more_data_required;
-            switch (*ptr_)
-            {
-                case '_':
-                case ':':
-                case '-':
-                    break;
-                    [[likely]] default:
-                    {
-                        if (!::isalnum(*ptr_))
-                            return result_t::ok;
-                    }
-            }
+            if (!xpar_detail::is_name_char(*ptr_))
+                return result_t::ok;
+
             *id_end_++ = *ptr_++;
-            if (++len == config_t::max_name_length) [[unlikely]]
+            if (options_t::check_limits && (++len == config_t::max_name_length)) [[unlikely]]
                 return result_t::limit_exceed;
         }
     }
@@ -170,10 +838,22 @@ namespace stdext
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::operator()(const char_t* buffer, const std::size_t buffer_size)
     {
+        base_offset_ += static_cast<std::uint64_t>(end_ - begin_);
         ptr_ = buffer;
+        begin_ = buffer;
         end_ = buffer + buffer_size;
+        count_begin_ = buffer;
         if (!line_begin_)
             line_begin_ = ptr_;
+        dispatch(dispatch_t {});
+
+        // the buffer may not outlive this call
+        fold_lines();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::dispatch(std::false_type)
+    {
         while ((ptr_ < end_) && (error_ == error_t::none))
             switch (state_)
             {
@@ -213,11 +893,168 @@ namespace stdext
                 case state_t::single_elem_end:
                     single_elem_end();
                     break;
+                case state_t::comment:
+                    comment();
+                    break;
+                case state_t::meta:
+                    meta();
+                    break;
+                case state_t::dtd:
+                    dtd();
+                    break;
+                case state_t::markup:
+                    markup();
+                    break;
+                case state_t::cdata_open:
+                    cdata_open();
+                    break;
+                case state_t::cdata:
+                    cdata();
+                    break;
+                case state_t::start_tag:
+                    start_tag();
+                    break;
+                case state_t::skip:
+                    skip();
+                    break;
                 default:
                     break;
             }
     }
 
+#if defined(__GNUC__)
+    // labels as values are a GNU extension, only instantiated for the configs asking for them
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::dispatch(std::true_type)
+    {
+        // one indirect jump per state function instead of the shared switch jump, indexed by state_t
+        static const void* const labels[] = {&&on_none, &&on_elem_handle, &&on_elem, &&on_elem_end, &&on_attr, &&on_attr_or_attr_value,
+                                             &&on_expect_attr_value, &&on_attr_value, &&on_data, &&on_comment, &&on_meta, &&on_dtd,
+                                             &&on_single_elem_end, &&on_markup, &&on_cdata_open, &&on_cdata, &&on_start_tag,
+                                             &&on_skip};
+    #define XPAR_NEXT()                                               \
+        if ((ptr_ >= end_) || (error_ != error_t::none)) [[unlikely]] \
+            return;                                                   \
+        goto* labels[static_cast<int>(state_)]
+
+        XPAR_NEXT();
+    on_none:
+        parse();
+        XPAR_NEXT();
+    on_elem_handle:
+        elem_handle();
+        XPAR_NEXT();
+    on_elem:
+        if (!item_read_)
+            elem_continue();
+        else
+            elem();
+        XPAR_NEXT();
+    on_elem_end:
+        elem_end_continue();
+        XPAR_NEXT();
+    on_attr:
+        if (!item_read_)
+            attr_continue();
+        else
+            attr();
+        XPAR_NEXT();
+    on_attr_or_attr_value:
+        attr_or_attr_value();
+        XPAR_NEXT();
+    on_expect_attr_value:
+        expect_attr_value();
+        XPAR_NEXT();
+    on_attr_value:
+        attr_value_continue();
+        XPAR_NEXT();
+    on_data:
+        data_continue();
+        XPAR_NEXT();
+    on_comment:
+        comment();
+        XPAR_NEXT();
+    on_meta:
+        meta();
+        XPAR_NEXT();
+    on_dtd:
+        dtd();
+        XPAR_NEXT();
+    on_single_elem_end:
+        single_elem_end();
+        XPAR_NEXT();
+    on_markup:
+        markup();
+        XPAR_NEXT();
+    on_cdata_open:
+        cdata_open();
+        XPAR_NEXT();
+    on_cdata:
+        cdata();
+        XPAR_NEXT();
+    on_start_tag:
+        start_tag();
+        XPAR_NEXT();
+    on_skip:
+        skip();
+        XPAR_NEXT();
+    #undef XPAR_NEXT
+    }
+    #pragma GCC diagnostic pop
+#endif
+
+    template <typename _Observer, typename _Config>
+    typename xpar<_Observer, _Config>::uint_t xpar<_Observer, _Config>::line() const noexcept
+    {
+        fold_lines();
+        return line_;
+    }
+
+    template <typename _Observer, typename _Config>
+    typename xpar<_Observer, _Config>::uint_t xpar<_Observer, _Config>::column() const noexcept
+    {
+        if (options_t::track_position)
+            return static_cast<uint_t>(1U + item_begin_ - line_begin_);
+
+        fold_lines();
+        return 1U + column_base_;
+    }
+
+    template <typename _Observer, typename _Config>
+    const typename xpar<_Observer, _Config>::char_t* xpar<_Observer, _Config>::last_line_begin() const noexcept
+    {
+        const char_t* line_begin = ptr_;
+        while ((line_begin != count_begin_) && (line_begin[-1] != '\n'))
+            --line_begin;
+        return line_begin;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::fold_lines() const noexcept
+    {
+        // without tracking, the lines are counted on request from where the previous request stopped, so each character is
+        // looked at once whatever the number of requests
+        if (options_t::track_position || (count_begin_ == ptr_))
+            return;
+
+        const char_t* const line_begin = last_line_begin();
+        line_ += static_cast<uint_t>(xpar_detail::count(count_begin_, line_begin, char_t('\n')));
+        column_base_ = static_cast<uint_t>((line_begin != count_begin_) ? ptr_ - line_begin : column_base_ + (ptr_ - count_begin_));
+        count_begin_ = ptr_;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::new_line() noexcept
+    {
+        if (options_t::track_position)
+        {
+            ++line_;
+            line_begin_ = ptr_;
+        }
+    }
+
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::parse()
     {
@@ -230,6 +1067,18 @@ namespace stdext
         }
     }
 
+    template <typename _Observer, typename _Config>
+    std::uint64_t xpar<_Observer, _Config>::tag_offset() const noexcept
+    {
+        if (options_t::lazy_attributes)
+            return tag_offset_;
+
+        // on_element_begin comes right after the name
+        return offset() - static_cast<std::uint64_t>(std::find(stack_pointer_, stack_pointer_ + config_t::max_name_length, char_t {}) -
+                                                      stack_pointer_) -
+               1U;
+    }
+
     template <typename _Observer, typename _Config>
     typename xpar<_Observer, _Config>::uint_t xpar<_Observer, _Config>::stack_size() const noexcept
     {
@@ -248,8 +1097,8 @@ namespace stdext
     {
         error_ = error;
         bool try_continue = config_t::try_continue_on_error;
-        observer_->on_error(*this, try_continue);
-        return try_continue;
+        xpar_detail::call_if(typename traits_t::on_error {}, *observer_, [&](auto& observer) { observer.on_error(*this, try_continue); });
+        return options_t::error_recovery && try_continue;
     }
 
     template <typename _Observer, typename _Config>
@@ -259,11 +1108,36 @@ namespace stdext
         {
             [[likely]] case result_t::ok:
             {
+                if (options_t::check_limits && (stack_size() + 1U >= config_t::max_stack_size)) [[unlikely]]
+                {
+                    // the element cannot be tracked, there is no recovery
+                    try_continue_handling_error(error_t::max_stack_size_exceeded);
+                    error_ = error_t::max_stack_size_exceeded;
+                    break;
+                }
+
                 item_read_ = true;
                 stack_pointer_ += config_t::max_name_length;
-                std::memcpy(stack_pointer_, id_, id_end_ - id_);
-                observer_->on_element_begin(*this, id_, id_end_);
-                id_end_ = id_;
+                std::memcpy(stack_pointer_, id_, sizeof(char_t) * (id_end_ - id_));
+                if (id_end_ - id_ != config_t::max_name_length)
+                    stack_pointer_[id_end_ - id_] = {};
+                if (options_t::lazy_attributes)
+                {
+                    // reported by start_tag() together with the attributes
+                    tag_offset_ = offset() - static_cast<std::uint64_t>(id_end_ - id_) - 1U;
+                    state_ = state_t::start_tag;
+                    id_end_ = id_;
+                    start_tag();
+                    break;
+                }
+
+                if (traits_t::wanted_attribute::value)
+                    element_hash_ = xpar_hash(id_, id_end_);
+                if (traits_t::on_start_tag::value)
+                    tag_name_end_ = id_ = id_end_;
+                else
+                    xpar_detail::call_if(typename traits_t::on_element_begin {}, *observer_,
+                                         [this](auto& observer) { observer.on_element_begin(*this, id_, id_end_); });
                 state_ = state_t::attr;
                 id_end_ = id_;
                 attr();
@@ -273,9 +1147,17 @@ namespace stdext
                 if (try_continue_handling_error(error_t::max_elem_name_length_exceeded))
                 {
                     error_ = {};
-                    state_ = state_t::attr;
                     id_end_ = id_;
-                    attr();
+                    if (options_t::lazy_attributes)
+                    {
+                        state_ = state_t::start_tag;
+                        start_tag();
+                    }
+                    else
+                    {
+                        state_ = state_t::attr;
+                        attr();
+                    }
                 }
 
                 break;
@@ -290,8 +1172,10 @@ namespace stdext
         if (*ptr_ == '>') [[likely]]
         {
             ++ptr_;
-            observer_->on_element_end(*this, nullptr, nullptr);
-            // observer_->on_element_end( *this, id_, id_end_);
+            const char_t* const name = stack_pointer_;
+            const char_t* const name_end = std::find(name, name + config_t::max_name_length, char_t {});
+            xpar_detail::call_if(typename traits_t::on_element_end {}, *observer_,
+                                 [&](auto& observer) { observer.on_element_end(*this, name, name_end); });
             stack_pointer_ -= config_t::max_name_length;
             state_ = {};
         }
@@ -309,10 +1193,13 @@ namespace stdext
         {
             ++ptr_;
             item_read_ = true;
-            if (std::memcmp((void*) stack_pointer_, id_, id_end_ - id_) == 0) [[likely]]
+            const std::size_t length = id_end_ - id_;
+            if ((std::memcmp(stack_pointer_, id_, sizeof(char_t) * length) == 0) &&
+                ((length == config_t::max_name_length) || (stack_pointer_[length] == char_t {}))) [[likely]]
             {
                 stack_pointer_ -= config_t::max_name_length;
-                observer_->on_element_end(*this, id_, id_end_);
+                xpar_detail::call_if(typename traits_t::on_element_end {}, *observer_,
+                                     [this](auto& observer) { observer.on_element_end(*this, id_, id_end_); });
                 state_ = {};
             }
             else if (try_continue_handling_error(error_t::elem_end_not_match))
@@ -359,14 +1246,12 @@ namespace stdext
                         if (*ptr_ == '\n')
                             ++ptr_;
 
-                        line_begin_ = ptr_;
-                        ++line_;
+                        new_line();
                     }
                     break;
                 case '\n':
                     ++ptr_;
-                    ++line_;
-                    line_begin_ = ptr_;
+                    new_line();
                     break;
                     [[likely]] case ' ': case '\t': case '\v':
                     {
@@ -388,7 +1273,7 @@ namespace stdext
             case '/':
                 state_ = state_t::elem_end;
                 while (++ptr_ < end_)
-                    if (::isalpha(*ptr_)) [[likely]]
+                    if (xpar_detail::is_name_start(*ptr_)) [[likely]]
                     {
                         elem_end_continue();
                         break;
@@ -400,29 +1285,20 @@ namespace stdext
                 break;
             case '?':
                 state_ = state_t::meta;
+                counter_ = 0U;
                 ++ptr_;
                 meta();
                 break;
             case '!':
+                state_ = state_t::markup;
                 ++ptr_;
                 if (ptr_ < end_) [[likely]]
-                {
-                    if (*ptr_ == '-') [[likely]]
-                    {
-                        state_ = state_t::comment;
-                        comment();
-                    }
-                    else
-                    {
-                        state_ = state_t::dtd;
-                        dtd();
-                    }
-                }
+                    markup();
                 break;
                 [[likely]] default:
                 {
                     for (;;)
-                        if (::isalpha(*ptr_)) [[likely]]
+                        if (xpar_detail::is_name_start(*ptr_)) [[likely]]
                         {
                             state_ = state_t::elem;
                             elem_continue();
@@ -442,50 +1318,171 @@ namespace stdext
         }
     }
 
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::markup()
+    {
+        if (*ptr_ == '-') [[likely]]
+        {
+            state_ = state_t::comment;
+            counter_ = 1U;
+            comment();
+        }
+        else if (*ptr_ == '[')
+        {
+            state_ = state_t::cdata_open;
+            counter_ = 0U;
+            cdata_open();
+        }
+        else if (options_t::doctype || try_continue_handling_error(error_t::unexpected_char))
+        {
+            error_ = {};
+            state_ = state_t::dtd;
+            counter_ = 1U;
+            dtd();
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::cdata_open()
+    {
+        // counter_ is the matched length of "[CDATA["
+        static constexpr char opening[] = "[CDATA[";
+        for (; (ptr_ < end_) && (counter_ != sizeof(opening) - 1U); ++ptr_, ++counter_)
+            if (*ptr_ != static_cast<char_t>(opening[counter_])) [[unlikely]]
+            {
+                // any other "<![" is skipped as a declaration, like before CDATA sections were reported
+                if (options_t::doctype || try_continue_handling_error(error_t::unexpected_char))
+                {
+                    error_ = {};
+                    state_ = state_t::dtd;
+                    counter_ = 1U;
+                    dtd();
+                }
+
+                return;
+            }
+
+        if (counter_ == sizeof(opening) - 1U)
+        {
+            state_ = state_t::cdata;
+            counter_ = 0U;
+            cdata();
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::cdata()
+    {
+        // counter_ is the number of ']' just read, up to 2; the ones ending a buffer are reported only if they are not the "]]>"
+        static const char_t brackets[] = {']', ']'};
+        const uint_t held = counter_;
+        const char_t* const text = ptr_;
+        const char_t* text_end = nullptr;
+        while (ptr_ < end_)
+        {
+            if (counter_ == 0U)
+            {
+                ptr_ = xpar_detail::find(ptr_, end_, char_t(']'));
+                if (ptr_ == end_)
+                    break;
+            }
+
+            if (*ptr_ == ']')
+                counter_ = std::min(counter_ + 1U, 2U);
+            else if ((*ptr_ == '>') && (counter_ == 2U))
+            {
+                text_end = ptr_;
+                break;
+            }
+            else
+                counter_ = 0U;
+
+            ++ptr_;
+        }
+
+        count_lines(text);
+
+        // the trailing brackets still unresolved, either the terminator or held for the next buffer
+        const uint_t pending = text_end ? 2U : counter_;
+        const uint_t read = static_cast<uint_t>(std::min<std::ptrdiff_t>(pending, (text_end ? text_end : ptr_) - text));
+        if (held > pending - read)
+            report_cdata(brackets, brackets + held - (pending - read), true);
+
+        if (text_end)
+        {
+            report_cdata(text, text_end - read, false);
+            ++ptr_;
+            counter_ = 0U;
+            state_ = {};
+        }
+        else if (ptr_ - read > text)
+            report_cdata(text, ptr_ - read, true);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::report_cdata(const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (traits_t::on_cdata::value)
+            xpar_detail::call_if(typename traits_t::on_cdata {}, *observer_,
+                                 [&](auto& observer) { observer.on_cdata(*this, text, text_end, partial); });
+        else
+            xpar_detail::call_if(typename traits_t::on_data {}, *observer_,
+                                 [&](auto& observer) { observer.on_data(*this, text, text_end, partial); });
+    }
+
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::comment()
     {
         const char_t* text = ptr_;
-        for (uint_t count = 1U; ptr_ < end_; ++ptr_)
+        for (; ptr_ < end_; ++ptr_)
             switch (*ptr_)
             {
                 case '-':
-                    ++count;
+                    ++counter_;
                     break;
                 case '>':
-                    if (count == 2U)
+                    if (counter_ == 2U)
                     {
                         ++ptr_;
                         state_ = {};
-                        observer_->on_comment(*this, text, ptr_, ptr_ == end_);
+                        if (options_t::report_comments)
+                            xpar_detail::call_if(typename traits_t::on_comment {}, *observer_,
+                                                 [&](auto& observer) { observer.on_comment(*this, text, ptr_, ptr_ == end_); });
                         return;
                     }
                     else if (try_continue_handling_error(error_t::unterminated_comment))
                     {
-                        count = 0U;
-                        ++ptr_;
+                        counter_ = 0U;
                         error_ = {};
                     }
+                    else
+                        return;
                     break;
                     [[likely]] default:
                     {
-                        if (count != 0U)
+                        if (counter_ != 0U)
                         {
-                            count = 0U;
+                            counter_ = 0U;
                         }
 
                         break;
                     }
             }
+
+        if (options_t::report_comments && (ptr_ > text))
+            xpar_detail::call_if(typename traits_t::on_comment {}, *observer_,
+                                 [&](auto& observer) { observer.on_comment(*this, text, ptr_, true); });
     }
 
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::meta()
     {
         for (; ptr_ < end_; ++ptr_)
-            if (*ptr_ == '>')
+            if (*ptr_ != '>')
+                counter_ = *ptr_ == '?';
+            else
             {
-                if (ptr_[-1] == '?')
+                if (counter_ != 0U)
                 {
                     ++ptr_;
                     state_ = {};
@@ -505,41 +1502,40 @@ namespace stdext
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::dtd()
     {
-        uint_t inner_elems = 1u;
         for (; ptr_ < end_; ++ptr_)
             switch (*ptr_)
             {
                 case '>':
-                    --inner_elems;
-                    if (inner_elems == 0u)
+                    if (--counter_ == 0U)
                     {
+                        ++ptr_;
                         state_ = {};
                         return;
                     }
                     break;
                 case '<':
-                    ++inner_elems;
+                    ++counter_;
                     break;
                     [[likely]] default:
                     {
                         break;
                     }
             }
-
-        if (inner_elems != 0U) [[unlikely]]
-        {
-            if (try_continue_handling_error(error_t::elem_end_not_match))
-            {
-                error_ = {};
-                ++ptr_;
-            }
-        }
     }
 
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::elem()
     {
         item_read_ = false;
+        skip_requested_ = false;
+        if (traits_t::on_start_tag::value)
+        {
+            id_ = tag_buffer_.data();
+            tag_name_end_ = nullptr;
+            pending_attribute_ = nullptr;
+            attribute_count_ = 0U;
+        }
+
         id_end_ = id_;
         ++ptr_;
         if (ptr_ < end_) [[likely]]
@@ -577,8 +1573,8 @@ namespace stdext
             state_ = state_t::expect_attr_value;
             expect_attr_value();
         }
-        else
-            attr();
+
+        // an attribute without value: the calling attr() loop goes on, a nested one would go past the tag end
     }
 
     template <typename _Observer, typename _Config>
@@ -589,7 +1585,29 @@ namespace stdext
             [[likely]] case result_t::ok:
             {
                 item_read_ = true;
-                observer_->on_attribute(*this, id_, id_end_);
+                skip_value_ = !attribute_wanted();
+                if (skip_value_)
+                    id_end_ = id_;
+                else if (!traits_t::on_start_tag::value)
+                    xpar_detail::call_if(typename traits_t::on_attribute {}, *observer_,
+                                         [this](auto& observer) { observer.on_attribute(*this, id_, id_end_); });
+                else if (attribute_count_ < options_t::max_attributes) [[likely]]
+                {
+                    pending_attribute_ = &attributes_[attribute_count_++];
+                    *pending_attribute_ = {id_, id_end_, nullptr, nullptr};
+                    id_ = id_end_;
+                }
+                else if (try_continue_handling_error(error_t::max_attr_count_exceeded))
+                {
+                    // the attribute is dropped together with its value, which is not stored
+                    error_ = {};
+                    pending_attribute_ = nullptr;
+                    id_end_ = id_;
+                    skip_value_ = true;
+                }
+                else
+                    break;
+
                 search_attr_value();
                 break;
             }
@@ -597,6 +1615,7 @@ namespace stdext
                 if (try_continue_handling_error(error_t::max_attr_name_length_exceeded))
                 {
                     error_ = {};
+                    skip_value_ = traits_t::wanted_attribute::value;
                     search_attr_value();
                 }
                 break;
@@ -622,16 +1641,18 @@ namespace stdext
                 case '>':
                     ++ptr_;
                     state_ = {};
+                    report_start_tag(false);
                     return;
                 case '/':
                     ++ptr_;
                     state_ = state_t::single_elem_end;
+                    report_start_tag(true);
                     if (ptr_ < end_)
                         single_elem_end();
                     return;
                     [[likely]] default:
                     {
-                        if (::isalpha(*ptr_)) [[likely]]
+                        if (xpar_detail::is_name_start(*ptr_)) [[likely]]
                         {
                             id_end_ = id_;
                             item_read_ = false;
@@ -649,12 +1670,280 @@ namespace stdext
         }
     }
 
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::start_tag()
+    {
+        // last_delimiter_ is the open quote; a tag split by the buffer end is copied to [id_, id_end_), item_read_ tells if it is named
+        // and skip_value_ if its attributes are dropped
+        static_assert(!options_t::lazy_attributes || !traits_t::on_start_tag::value, "on_start_tag needs the attributes parsed");
+        const char_t* const text = ptr_;
+        while (ptr_ < end_)
+        {
+            if (last_delimiter_ != char_t {})
+            {
+                ptr_ = xpar_detail::find(ptr_, end_, last_delimiter_);
+                if (ptr_ == end_)
+                    break;
+                last_delimiter_ = {};
+                ++ptr_;
+            }
+            else
+            {
+                ptr_ = xpar_detail::find_tag_end(ptr_, end_);
+                if ((ptr_ == end_) || (*ptr_ == '>'))
+                    break;
+                last_delimiter_ = *ptr_++;
+            }
+        }
+
+        count_lines(text);
+
+        const char_t* attributes = text;
+        const char_t* attributes_end = ptr_;
+        if (skip_value_ || (id_end_ != id_) || (ptr_ == end_))
+        {
+            const std::size_t length = (id_end_ - id_) + (ptr_ - text);
+            if (skip_value_ || (options_t::check_limits && (length > config_t::max_value_length))) [[unlikely]]
+            {
+                if (!skip_value_ && !try_continue_handling_error(error_t::max_attr_value_length_exceeded))
+                    return;
+                // the attributes of the tag are dropped up to its end, the last character is kept for the '/' of an empty tag
+                error_ = {};
+                skip_value_ = true;
+                if (ptr_ != text)
+                {
+                    *id_ = ptr_[-1];
+                    id_end_ = id_ + 1;
+                }
+            }
+            else
+            {
+                std::memcpy(id_end_, text, sizeof(char_t) * (ptr_ - text));
+                id_end_ += ptr_ - text;
+            }
+
+            attributes = id_;
+            attributes_end = id_end_;
+        }
+
+        if (ptr_ == end_)
+            return;
+
+        const bool empty = (attributes != attributes_end) && (attributes_end[-1] == '/');
+        if (empty)
+            --attributes_end;
+        if (skip_value_)
+            attributes = attributes_end;
+        skip_value_ = false;
+        if (item_read_)
+        {
+            const char_t* const name = stack_pointer_;
+            const char_t* const name_end = std::find(name, name + config_t::max_name_length, char_t {});
+            const xpar_attributes<char_t> raw(attributes, attributes_end);
+            if (traits_t::on_element_begin_raw::value)
+                xpar_detail::call_if(typename traits_t::on_element_begin_raw {}, *observer_,
+                                     [&](auto& observer) { observer.on_element_begin(*this, name, name_end, raw); });
+            else
+                xpar_detail::call_if(typename traits_t::on_element_begin {}, *observer_,
+                                     [&](auto& observer) { observer.on_element_begin(*this, name, name_end); });
+        }
+
+        id_end_ = id_;
+        if (empty)
+        {
+            state_ = state_t::single_elem_end;
+            report_start_tag(true);
+            single_elem_end();
+        }
+        else
+        {
+            ++ptr_;
+            state_ = {};
+            report_start_tag(false);
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::skip()
+    {
+        // counter_ is the depth, it drops on "</" so the skip ends at the '>' closing a depth 0 tag;
+        // skip_match_ counts the terminator characters read: '-' of "-->", ']' of "]]>", '?' of "?>", item_read_ a '/' before '>'
+        const char_t* const text = ptr_;
+        while (ptr_ < end_)
+            switch (skip_)
+            {
+                case skip_t::text:
+                    ptr_ = xpar_detail::find(ptr_, end_, char_t('<'));
+                    if (ptr_ != end_)
+                    {
+                        ++ptr_;
+                        skip_ = skip_t::open;
+                    }
+                    break;
+                case skip_t::open:
+                    skip_match_ = 0U;
+                    item_read_ = false;
+                    skip_ = skip_t::start_tag;
+                    switch (*ptr_)
+                    {
+                        case '/':
+                            skip_ = skip_t::tag_end;
+                            --counter_;
+                            if (options_t::track_position)
+                                item_begin_ = ptr_ + 1;
+                            ++ptr_;
+                            break;
+                        case '!':
+                            skip_ = skip_t::markup;
+                            ++ptr_;
+                            break;
+                        case '?':
+                            skip_ = skip_t::pi;
+                            ++ptr_;
+                            break;
+                        default:
+                            break;
+                    }
+                    break;
+                case skip_t::markup:
+                    skip_ = (*ptr_ == '-') ? skip_t::comment : (*ptr_ == '[') ? skip_t::cdata : skip_t::tag_end;
+                    break;
+                case skip_t::start_tag:
+                    if (last_delimiter_ != char_t {})
+                    {
+                        ptr_ = xpar_detail::find(ptr_, end_, last_delimiter_);
+                        if (ptr_ != end_)
+                        {
+                            last_delimiter_ = {};
+                            item_read_ = false;
+                            ++ptr_;
+                        }
+                    }
+                    else
+                    {
+                        const char_t* const found = xpar_detail::find_tag_end(ptr_, end_);
+                        if (found != ptr_)
+                            item_read_ = found[-1] == '/';
+                        ptr_ = found;
+                        if (ptr_ == end_)
+                            break;
+                        if (*ptr_ != '>')
+                            last_delimiter_ = *ptr_;
+                        else
+                        {
+                            counter_ += item_read_ ? 0U : 1U;
+                            skip_ = skip_t::text;
+                        }
+
+                        item_read_ = false;
+                        ++ptr_;
+                    }
+                    break;
+                case skip_t::tag_end:
+                    ptr_ = xpar_detail::find(ptr_, end_, char_t('>'));
+                    if (ptr_ == end_)
+                        break;
+                    skip_ = skip_t::text;
+                    if (counter_ == 0U)
+                    {
+                        // the end tag of the skipped element, reported like the end of an empty one
+                        count_lines(text);
+                        state_ = state_t::single_elem_end;
+                        single_elem_end();
+                        return;
+                    }
+
+                    ++ptr_;
+                    break;
+                default:
+                {
+                    // comment, CDATA section or processing instruction, the terminator is 2 repeated or 1 character and '>'
+                    const char_t repeated = (skip_ == skip_t::comment) ? '-' : (skip_ == skip_t::cdata) ? ']' : '?';
+                    const uint_t needed = (skip_ == skip_t::pi) ? 1U : 2U;
+                    if (skip_match_ == 0U)
+                    {
+                        ptr_ = xpar_detail::find(ptr_, end_, repeated);
+                        if (ptr_ == end_)
+                            break;
+                    }
+
+                    if (*ptr_ == repeated)
+                        skip_match_ = std::min(skip_match_ + 1U, needed);
+                    else if ((*ptr_ == '>') && (skip_match_ == needed))
+                        skip_ = skip_t::text;
+                    else
+                        skip_match_ = 0U;
+                    ++ptr_;
+                    break;
+                }
+            }
+
+        count_lines(text);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::count_lines(const char_t* text) noexcept
+    {
+        // the lines of [text, ptr_) skipped without looking at the characters one by one
+        if (options_t::track_position)
+        {
+            const char_t* line_begin = ptr_;
+            while ((line_begin != text) && (line_begin[-1] != '\n'))
+                --line_begin;
+            line_ += static_cast<uint_t>(xpar_detail::count(text, line_begin, char_t('\n')));
+            if (line_begin != text)
+                line_begin_ = line_begin;
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar<_Observer, _Config>::attribute_wanted()
+    {
+        bool result = true;
+        if (!traits_t::wanted_attribute::value)
+            return result;
+
+        const std::uint32_t hash = xpar_hash(id_, id_end_);
+        xpar_detail::call_if(typename traits_t::wanted_attribute {}, *observer_,
+                             [&](auto& observer) { result = observer.wanted_attribute(*this, element_hash_, hash); });
+        return result;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::report_start_tag(const bool empty)
+    {
+        static_assert(!traits_t::on_start_tag::value || (options_t::max_attributes != 0U), "on_start_tag requires max_attributes");
+        if (traits_t::on_start_tag::value)
+        {
+            const char_t* const name = tag_buffer_.data();
+            const attribute_t* const attributes = attributes_.data();
+            if (tag_name_end_)
+                xpar_detail::call_if(typename traits_t::on_start_tag {}, *observer_, [&](auto& observer)
+                                     { observer.on_start_tag(*this, name, tag_name_end_, attributes, attributes + attribute_count_); });
+            id_ = value_buffer_.data();
+            id_end_ = id_;
+        }
+
+        xpar_detail::call_if(typename traits_t::on_start_tag_end {}, *observer_,
+                             [this, empty](auto& observer) { observer.on_start_tag_end(*this, empty); });
+        if (skip_requested_)
+        {
+            skip_requested_ = false;
+            if (!empty)
+            {
+                state_ = state_t::skip;
+                skip_ = skip_t::text;
+                counter_ = 1U;
+            }
+        }
+    }
+
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::attr_or_attr_value()
     {
         if (space())
         {
-            if (::isalpha(*ptr_)) [[likely]]
+            if (xpar_detail::is_name_start(*ptr_)) [[likely]]
                 attr();
             else if (*ptr_ == '=')
             {
@@ -683,11 +1972,27 @@ namespace stdext
     void xpar<_Observer, _Config>::attr_value_continue()
     {
         std::size_t len = id_end_ - id_;
-        const std::size_t limit = std::min<std::size_t>(end_ - ptr_, config_t::max_value_length);
-        for (; (len < limit) && (*ptr_ != last_delimiter_); ++len)
-            *id_end_++ = *ptr_++;
+        if ((!traits_t::on_attribute_value::value && !traits_t::on_start_tag::value) || skip_value_)
+        {
+            // nobody reads the value, only look for its end
+            ptr_ = xpar_detail::find(ptr_, end_, last_delimiter_);
+            len = 0U;
+        }
+        else if (!options_t::check_limits)
+        {
+            const char_t* const value_end = xpar_detail::find(ptr_, end_, last_delimiter_);
+            std::memcpy(id_end_, ptr_, sizeof(char_t) * (value_end - ptr_));
+            id_end_ += value_end - ptr_;
+            ptr_ = value_end;
+        }
+        else
+        {
+            const std::size_t limit = std::min<std::size_t>(len + (end_ - ptr_), config_t::max_value_length);
+            for (; (len < limit) && (*ptr_ != last_delimiter_); ++len)
+                *id_end_++ = *ptr_++;
+        }
 
-        if (len == config_t::max_value_length) [[unlikely]]
+        if (options_t::check_limits && (len == config_t::max_value_length)) [[unlikely]]
         {
             if (try_continue_handling_error(error_t::max_attr_value_length_exceeded))
             {
@@ -702,7 +2007,21 @@ namespace stdext
 
         if ((ptr_ < end_) && (*ptr_ == last_delimiter_)) [[likely]]
         {
-            observer_->on_attribute_value(*this, id_, id_end_, false);
+            if (options_t::decode_references && !skip_value_)
+                id_end_ = xpar_detail::decode_in_place(id_, id_end_);
+            if (skip_value_)
+                skip_value_ = false;
+            else if (!traits_t::on_start_tag::value)
+                xpar_detail::call_if(typename traits_t::on_attribute_value {}, *observer_,
+                                     [this](auto& observer) { observer.on_attribute_value(*this, id_, id_end_, false); });
+            else if (pending_attribute_)
+            {
+                pending_attribute_->value = id_;
+                pending_attribute_->value_end = id_end_;
+                pending_attribute_ = nullptr;
+                id_ = id_end_;
+            }
+
             last_delimiter_ = {};
             ++ptr_;
             state_ = state_t::attr;
@@ -713,6 +2032,12 @@ namespace stdext
     void xpar<_Observer, _Config>::data()
     {
         state_ = state_t::data;
+        if (options_t::trim_text)
+        {
+            item_read_ = false;
+            id_end_ = id_;
+        }
+
         data_continue();
     }
 
@@ -720,6 +2045,8 @@ namespace stdext
     void xpar<_Observer, _Config>::data_continue()
     {
         const char_t* const text = ptr_;
+        if (!options_t::track_position)
+            ptr_ = xpar_detail::find(ptr_, end_, char_t('<'));
         while (ptr_ < end_)
             switch (*ptr_)
             {
@@ -737,21 +2064,308 @@ namespace stdext
             }
 exit:
         const bool end = ptr_ == end_;
-        if (ptr_ > text)
-            observer_->on_data(*this, text, ptr_, end);
+        if (options_t::trim_text)
+            trimmed_data(text, end);
+        else if ((ptr_ > text) || (reference_size_ != 0U))
+            report_data(text, ptr_, end); // an incomplete reference held at the previous buffer end is reported as text
 
         if (!end)
             elem();
     }
 
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::trimmed_data(const char_t* text, const bool partial)
+    {
+        // item_read_ tells the text was reported, [id_, id_end_) keeps the whitespace ending the previous buffer
+        const char_t* text_end = ptr_;
+        while ((text_end > text) && xpar_detail::is_space(text_end[-1]))
+            --text_end;
+
+        if (text_end != text)
+        {
+            if (id_end_ != id_)
+                report_data(id_, id_end_, true);
+            report_data(text, text_end, partial);
+            id_end_ = id_;
+            item_read_ = true;
+        }
+        else if (!partial && item_read_)
+            report_data(ptr_, ptr_, false);
+
+        if (partial)
+        {
+            const std::size_t size = ptr_ - text_end;
+            if (size > static_cast<std::size_t>(value_buffer_.data() + value_buffer_.size() - id_end_)) [[unlikely]]
+            {
+                // too long to keep, report it as part of the text
+                if (id_end_ != id_)
+                    report_data(id_, id_end_, true);
+                report_data(text_end, ptr_, true);
+                id_end_ = id_;
+                item_read_ = true;
+            }
+            else
+            {
+                std::memcpy(id_end_, text_end, sizeof(char_t) * size);
+                id_end_ += size;
+            }
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::report_data(const char_t* text, const char_t* text_end, const bool partial)
+    {
+        xpar_detail::call_if(
+            typename traits_t::on_data {}, *observer_,
+            [&](auto& observer)
+            {
+                const char_t* in = options_t::decode_references ? xpar_detail::find(text, text_end, char_t('&')) : text_end;
+                if ((in == text_end) && (reference_size_ == 0U)) [[likely]]
+                {
+                    observer.on_data(*this, text, text_end, partial);
+                    return;
+                }
+
+                // decode into the scratch buffer, reporting it each time it fills up
+                char_t* const scratch = scratch_buffer_.data();
+                char_t* const scratch_end = scratch + scratch_buffer_.size();
+                char_t* out = scratch;
+                in = text;
+                if (reference_size_ != 0U)
+                {
+                    // complete the reference split by the previous buffer end
+                    const uint_t size = reference_size_;
+                    const auto tail = std::min<std::size_t>(text_end - text, reference_buffer_.size() - size);
+                    std::copy(text, text + tail, reference_buffer_.data() + size);
+                    const char_t* const reference_end = xpar_detail::decode_reference<char_t>(reference_buffer_.data(),
+                                                                                             reference_buffer_.data() + size + tail, out);
+                    if (!reference_end && partial)
+                    {
+                        reference_size_ += static_cast<uint_t>(tail);
+                        return;
+                    }
+
+                    reference_size_ = 0U;
+                    if (reference_end && (reference_end != reference_buffer_.data()))
+                        in = text + (reference_end - reference_buffer_.data() - size);
+                    else
+                        out = std::copy(reference_buffer_.data(), reference_buffer_.data() + size, out);
+                }
+
+                for (;;)
+                {
+                    const char_t* const amp = xpar_detail::find(in, text_end, char_t('&'));
+                    while (scratch_end - out < amp - in)
+                    {
+                        std::copy(in, in + (scratch_end - out), out);
+                        in += scratch_end - out;
+                        observer.on_data(*this, scratch, scratch_end, true);
+                        out = scratch;
+                    }
+
+                    out = std::copy(in, amp, out);
+                    if (amp == text_end)
+                        break;
+
+                    if (scratch_end - out < 4)
+                    {
+                        observer.on_data(*this, scratch, out, true);
+                        out = scratch;
+                    }
+
+                    in = xpar_detail::decode_reference(amp, text_end, out);
+                    if (!in && partial)
+                    {
+                        reference_size_ = static_cast<uint_t>(text_end - amp);
+                        std::copy(amp, text_end, reference_buffer_.data());
+                        break;
+                    }
+
+                    if (!in || (in == amp))
+                    {
+                        *out++ = '&';
+                        in = amp + 1;
+                    }
+                }
+
+                if ((out != scratch) || !partial)
+                    observer.on_data(*this, scratch, out, partial);
+            });
+    }
+
     template <typename _Observer, typename _Config>
     void xpar<_Observer, _Config>::reset() noexcept
     {
+        ptr_ = {};
+        begin_ = {};
+        end_ = {};
         line_begin_ = {};
         item_begin_ = {};
+        count_begin_ = {};
+        id_ = value_buffer_.data();
+        id_end_ = id_;
+        tag_name_end_ = {};
+        pending_attribute_ = {};
+        stack_pointer_ = stack_buffer_.data();
+        base_offset_ = {};
+        tag_offset_ = {};
         line_ = 1U;
+        counter_ = {};
+        column_base_ = {};
+        reference_size_ = {};
+        attribute_count_ = {};
         state_ = {};
         error_ = {};
+        last_delimiter_ = {};
         item_read_ = {};
+        skip_value_ = {};
+        skip_requested_ = {};
+        skip_ = {};
+        skip_match_ = {};
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar<_Observer, _Config>::seek(const std::uint64_t offset, const uint_t line) noexcept
+    {
+        reset();
+        base_offset_ = offset;
+        line_ = line;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar<_Observer, _Config>::push_element(const char_t* name, const char_t* name_end) noexcept
+    {
+        const std::size_t length = name_end - name;
+        if ((length > config_t::max_name_length) || (stack_size() + 1U >= config_t::max_stack_size))
+            return false;
+
+        stack_pointer_ += config_t::max_name_length;
+        std::memcpy(stack_pointer_, name, sizeof(char_t) * length);
+        if (length != config_t::max_name_length)
+            stack_pointer_[length] = {};
+        return true;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::size_t xpar<_Observer, _Config>::checkpoint(void* const buffer, const std::size_t buffer_size) const noexcept
+    {
+        // layout: version, state, error, flags (item_read, skip_value, skip (3 bits), skip_match (2 bits), skip_requested), depth,
+        // id length, line, counter, offset, byte order mark, sizeof(char_t), max_name_length, max_stack_size (uint16),
+        // max_value_length (uint32), last delimiter, id, (length (uint16), name) per level
+        const uint_t depth = stack_size();
+        const std::size_t id_length = id_end_ - id_;
+        std::size_t size = checkpoint_header_size + sizeof(char_t) * (1U + id_length) + sizeof(std::uint16_t) * depth;
+        for (uint_t i = 1U; i <= depth; ++i)
+            size += sizeof(char_t) * (std::find(stack_value(i), stack_value(i) + config_t::max_name_length, char_t {}) - stack_value(i));
+
+        const bool start_tag = traits_t::on_start_tag::value && (state_ >= state_t::elem_handle) && (state_ <= state_t::attr_value);
+        if ((size > buffer_size) || (reference_size_ != 0U) || start_tag)
+            return 0U;
+
+        auto out = static_cast<unsigned char*>(buffer);
+        const auto flags = static_cast<std::uint8_t>(item_read_ | (skip_value_ << 1U) | (static_cast<unsigned>(skip_) << 2U) |
+                                                     (skip_match_ << 5U) | (skip_requested_ << 7U));
+        const std::uint8_t header[] = {checkpoint_version, static_cast<std::uint8_t>(state_), static_cast<std::uint8_t>(error_), flags};
+        const std::uint16_t lengths[] = {static_cast<std::uint16_t>(depth), static_cast<std::uint16_t>(id_length)};
+        const std::uint32_t counters[] = {line(), counter_};
+        const std::uint64_t position = offset();
+        std::memcpy(out, header, sizeof(header));
+        std::memcpy(out + 4, lengths, sizeof(lengths));
+        std::memcpy(out + 8, counters, sizeof(counters));
+        std::memcpy(out + 16, &position, sizeof(position));
+        const std::uint16_t format[] = {1U, sizeof(char_t), config_t::max_name_length, config_t::max_stack_size};
+        const std::uint32_t max_value_length = config_t::max_value_length;
+        std::memcpy(out + 24, format, sizeof(format));
+        std::memcpy(out + 32, &max_value_length, sizeof(max_value_length));
+        out += checkpoint_header_size;
+        std::memcpy(out, &last_delimiter_, sizeof(char_t));
+        out += sizeof(char_t);
+        std::memcpy(out, id_, sizeof(char_t) * id_length);
+        out += sizeof(char_t) * id_length;
+        for (uint_t i = 1U; i <= depth; ++i)
+        {
+            const char_t* const name = stack_value(i);
+            const auto length = static_cast<std::uint16_t>(std::find(name, name + config_t::max_name_length, char_t {}) - name);
+            std::memcpy(out, &length, sizeof(length));
+            out += sizeof(length);
+            std::memcpy(out, name, sizeof(char_t) * length);
+            out += sizeof(char_t) * length;
+        }
+
+        return size;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar<_Observer, _Config>::restore(const void* const data, const std::size_t size) noexcept
+    {
+        auto in = static_cast<const unsigned char*>(data);
+        const auto end = in + size;
+        std::uint8_t header[4];
+        std::uint16_t lengths[2];
+        std::uint32_t counters[2];
+        std::uint64_t position;
+        std::uint16_t format[4];
+        std::uint32_t max_value_length;
+        if (size < checkpoint_header_size + sizeof(char_t))
+            return false;
+
+        std::memcpy(header, in, sizeof(header));
+        std::memcpy(lengths, in + 4, sizeof(lengths));
+        std::memcpy(counters, in + 8, sizeof(counters));
+        std::memcpy(&position, in + 16, sizeof(position));
+        std::memcpy(format, in + 24, sizeof(format));
+        std::memcpy(&max_value_length, in + 32, sizeof(max_value_length));
+        if ((header[0] != checkpoint_version) || (format[0] != 1U) || (format[1] != sizeof(char_t)) ||
+            (format[2] > config_t::max_name_length) || (format[3] > config_t::max_stack_size) ||
+            (max_value_length > config_t::max_value_length) || (header[1] > static_cast<std::uint8_t>(state_t::skip)) ||
+            (header[2] > static_cast<std::uint8_t>(error_t::max_stack_size_exceeded)) || (lengths[0] >= config_t::max_stack_size) ||
+            (lengths[1] > config_t::max_value_length) ||
+            (end - in < static_cast<std::ptrdiff_t>(checkpoint_header_size + sizeof(char_t) * (1U + lengths[1]))))
+            return false;
+
+        reset();
+        in += checkpoint_header_size;
+        std::memcpy(&last_delimiter_, in, sizeof(char_t));
+        in += sizeof(char_t);
+        std::memcpy(id_, in, sizeof(char_t) * lengths[1]);
+        in += sizeof(char_t) * lengths[1];
+        id_end_ = id_ + lengths[1];
+        for (uint_t i = 0U; i != lengths[0]; ++i)
+        {
+            std::uint16_t length;
+            if (static_cast<std::size_t>(end - in) < sizeof(length))
+            {
+                reset();
+                return false;
+            }
+
+            std::memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            if ((length > config_t::max_name_length) || (static_cast<std::size_t>(end - in) < sizeof(char_t) * length))
+            {
+                reset();
+                return false;
+            }
+
+            stack_pointer_ += config_t::max_name_length;
+            std::memcpy(stack_pointer_, in, sizeof(char_t) * length);
+            if (length != config_t::max_name_length)
+                stack_pointer_[length] = {};
+            in += sizeof(char_t) * length;
+        }
+
+        state_ = static_cast<state_t>(header[1]);
+        error_ = static_cast<error_t>(header[2]);
+        item_read_ = (header[3] & 1U) != 0U;
+        skip_value_ = (header[3] & 2U) != 0U;
+        skip_ = static_cast<skip_t>((header[3] >> 2U) & 7U);
+        skip_match_ = (header[3] >> 5U) & 3U;
+        skip_requested_ = (header[3] & 128U) != 0U;
+        if (traits_t::wanted_attribute::value && (lengths[0] != 0U))
+            element_hash_ = xpar_hash(stack_pointer_, std::find(stack_pointer_, stack_pointer_ + config_t::max_name_length, char_t {}));
+        line_ = counters[0];
+        counter_ = counters[1];
+        base_offset_ = position;
+        return true;
     }
 }
@@ -0,0 +1,486 @@
+/// xpar_bind - Declarative binding of repeated elements to C++ structs
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include "xpar_value.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <string>
+    #include <tuple>
+    #include <type_traits>
+    #include <utility>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /// Converts with xpar_parse; a std::vector member gets a new element per value, e.g. one per repeated child element.
+    struct xpar_default_converter
+    {
+        template <typename _Char, typename _Value>
+        bool operator()(const _Char* text, const _Char* text_end, _Value& value) const
+        {
+            return xpar_parse(text, text_end, value);
+        }
+
+        template <typename _Char, typename _Value, typename _Allocator>
+        bool operator()(const _Char* text, const _Char* text_end, std::vector<_Value, _Allocator>& values) const
+        {
+            _Value value {};
+            if (!xpar_parse(text, text_end, value))
+                return false;
+
+            values.push_back(std::move(value));
+            return true;
+        }
+    };
+
+    /// A struct member and the path of its value relative to the record element: "labl" or "sumStat/@type" select the text or an
+    /// attribute of a descendant, "@name" an attribute of the record and "." its own text.
+    template <typename _Record, typename _Member, typename _Converter>
+    struct xpar_member_binding
+    {
+        using record_t = _Record;
+        using member_t = _Member;
+        using converter_t = _Converter; // bool (const char_t* text, const char_t* text_end, _Member& member)
+
+        const char* path;
+        _Member _Record::*member;
+        _Converter converter;
+    };
+
+    template <typename _Record, typename _Member>
+    constexpr xpar_member_binding<_Record, _Member, xpar_default_converter> xpar_member(const char* path, _Member _Record::*member) noexcept
+    {
+        return {path, member, {}};
+    }
+
+    template <typename _Record, typename _Member, typename _Converter>
+    constexpr xpar_member_binding<_Record, _Member, _Converter> xpar_member(const char* path, _Member _Record::*member,
+                                                                            const _Converter& converter)
+    {
+        return {path, member, converter};
+    }
+
+    /// The record element path, "/codeBook/dataDscr/var" or "//var" for such an element anywhere outside a record, and its members.
+    template <typename _Record, typename... _Members>
+    class xpar_binding
+    {
+    public:
+        using record_t = _Record;
+        using members_t = std::tuple<_Members...>;
+
+        constexpr xpar_binding(const char* record, const _Members&... members): record_(record), members_(members...) {}
+
+        constexpr const char* record() const noexcept { return record_; }
+        constexpr const members_t& members() const noexcept { return members_; }
+
+    private:
+        const char* record_;
+        members_t members_;
+    };
+
+    template <typename _Record, typename... _Members>
+    constexpr xpar_binding<_Record, _Members...> xpar_bind(const char* record, const _Members&... members)
+    {
+        return {record, members...};
+    }
+
+    /// Appends a record to the caller's vector for every element the binding's record path selects and writes the bound values
+    /// straight into its members. The elements are looked up by name hash in a tree built from the member paths; an element no
+    /// member is bound below is skipped by the parser, so are the elements off an absolute record path. Text interrupted by child
+    /// elements is converted run by run, a std::basic_string member gets the runs appended. Values a converter rejects leave
+    /// their member as it is and are counted by conversion_errors().
+    template <typename _Binding, typename _Config = xpar_default_config>
+    class xpar_binder
+    {
+    public:
+        using binding_t = _Binding;
+        using record_t = typename _Binding::record_t;
+        using config_t = _Config;
+        using xpar_t = xpar<xpar_binder, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using string_t = std::basic_string<char_t>;
+
+        xpar_binder(const binding_t& binding, std::vector<record_t>* const records);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { parser_(buffer, buffer_size); }
+
+        /// False if the record path or a member path could not be read, nothing is bound then.
+        bool valid() const noexcept { return valid_; }
+        std::size_t conversion_errors() const noexcept { return conversion_errors_; }
+
+        xpar_t& parser() noexcept { return parser_; }
+        std::vector<record_t>* records() const noexcept { return records_; }
+
+        /// Restarts the parsing; the records read so far are kept.
+        void reset();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        bool wanted_attribute(const xpar_t& parser, const std::uint32_t element, const std::uint32_t attribute) const noexcept;
+        void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_data(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+
+    protected:
+        enum constant : std::uint32_t
+        {
+            no_field = 0xFFFFFFFFU,
+            outside = 0xFFFFFFFEU, // on the record path, outside a record
+            skipped = 0xFFFFFFFDU,
+        };
+
+        // writes a value, or its next piece for a member taking the pieces as they come
+        using store_t = bool (*)(const binding_t& binding, record_t& record, const char_t* text, const char_t* text_end, const bool first);
+
+        struct field_t
+        {
+            store_t store;
+            bool piecewise;
+        };
+
+        struct node_t
+        {
+            string_t name;
+            std::uint32_t hash;
+            std::uint32_t text; // field, no_field if the text is not bound
+            std::vector<std::uint32_t> children;
+            bool live; // the text or a descendant is bound
+        };
+
+        struct attribute_t
+        {
+            std::uint32_t node;
+            std::uint32_t hash;
+            string_t name;
+            std::uint32_t field;
+        };
+
+        struct entry_t
+        {
+            std::uint32_t node;
+            bool text; // a text piece was stored already
+        };
+
+        template <typename _Member>
+        struct piecewise: std::integral_constant<bool, std::is_same<typename _Member::member_t, string_t>::value &&
+                                                           std::is_same<typename _Member::converter_t, xpar_default_converter>::value>
+        {
+        };
+
+        template <std::size_t _Index>
+        static bool store_field(const binding_t& binding, record_t& record, const char_t* text, const char_t* text_end, const bool first);
+        template <typename _Member>
+        static bool store(const _Member& member, record_t& record, const char_t* text, const char_t* text_end, const bool first,
+                          std::true_type /*piecewise*/);
+        template <typename _Member>
+        static bool store(const _Member& member, record_t& record, const char_t* text, const char_t* text_end, const bool first,
+                          std::false_type /*piecewise*/);
+
+        template <std::size_t... _Indexes>
+        void add_fields(std::index_sequence<_Indexes...>);
+        bool add_field(const char* path, const std::uint32_t field);
+        std::uint32_t child(const std::uint32_t node, const char_t* name, const char_t* name_end, const std::uint32_t hash) const noexcept;
+        void write(const std::uint32_t field, const char_t* text, const char_t* text_end, const bool partial, bool& stored);
+        void flush();
+
+        xpar_t parser_ {this};
+        binding_t binding_;
+        std::vector<record_t>* records_;
+        std::vector<field_t> fields_ {};
+        std::vector<node_t> nodes_ {}; // the record element first
+        std::vector<attribute_t> attributes_ {};
+        std::vector<string_t> path_ {}; // record path names
+        std::vector<entry_t> stack_ {};
+        string_t pending_ {}; // pieces of a value converted as a whole
+        std::uint32_t pending_field_ {no_field};
+        std::size_t conversion_errors_ {};
+        std::size_t record_depth_ {}; // stack size at the record element, 0 outside records
+        std::uint32_t attribute_ {no_field};
+        bool descendant_ {};
+        bool attribute_stored_ {};
+        bool valid_ {true};
+    };
+
+    template <typename _Binding, typename _Config>
+    xpar_binder<_Binding, _Config>::xpar_binder(const binding_t& binding, std::vector<record_t>* const records):
+        binding_(binding), records_(records)
+    {
+        const char* path = binding.record();
+        const char* const path_end = path + std::char_traits<char>::length(path);
+        descendant_ = (path_end - path > 1) && (path[0] == '/') && (path[1] == '/');
+        path += descendant_ ? 1 : 0;
+        while (valid_ && (path != path_end))
+        {
+            const char* const name = path + 1;
+            path = std::find(name, path_end, '/');
+            valid_ = (name[-1] == '/') && (name != path);
+            path_.emplace_back(name, path);
+        }
+
+        // "//name" only, no "//a/b"
+        valid_ = valid_ && !path_.empty() && (!descendant_ || (path_.size() == 1U));
+        nodes_.push_back({path_.empty() ? string_t() : path_.back(), 0U, no_field, {}, false});
+        add_fields(std::make_index_sequence<std::tuple_size<typename binding_t::members_t>::value> {});
+    }
+
+    template <typename _Binding, typename _Config>
+    template <std::size_t... _Indexes>
+    void xpar_binder<_Binding, _Config>::add_fields(std::index_sequence<_Indexes...>)
+    {
+        using members_t = typename binding_t::members_t;
+        fields_ = {field_t {&store_field<_Indexes>, piecewise<typename std::tuple_element<_Indexes, members_t>::type>::value}...};
+        const char* const paths[] = {std::get<_Indexes>(binding_.members()).path..., nullptr};
+        for (std::uint32_t field = 0U; field != fields_.size(); ++field)
+            valid_ = add_field(paths[field], field) && valid_;
+    }
+
+    template <typename _Binding, typename _Config>
+    bool xpar_binder<_Binding, _Config>::add_field(const char* path, const std::uint32_t field)
+    {
+        const char* const path_end = path + std::char_traits<char>::length(path);
+        if (path == path_end)
+            return false;
+        if ((path_end - path == 1) && (*path == '.'))
+        {
+            nodes_.front().text = field;
+            nodes_.front().live = true;
+            return true;
+        }
+
+        std::uint32_t node = 0U;
+        std::vector<std::uint32_t> visited {node};
+        while (path != path_end)
+        {
+            const char* const name = path;
+            path = std::find(path, path_end, '/');
+            if ((name == path) || (path + 1 == path_end))
+                return false;
+
+            const string_t step(name, path);
+            path += (path != path_end) ? 1 : 0;
+            if (*name == '@')
+            {
+                if ((path != path_end) || (step.size() == 1U))
+                    return false;
+
+                attributes_.push_back({node, xpar_hash(step.data() + 1, step.data() + step.size()), step.substr(1U), field});
+                return true;
+            }
+
+            const std::uint32_t hash = xpar_hash(step.data(), step.data() + step.size());
+            std::uint32_t next = child(node, step.data(), step.data() + step.size(), hash);
+            if (next == no_field)
+            {
+                next = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.push_back({step, hash, no_field, {}, false});
+                nodes_[node].children.push_back(next);
+            }
+
+            node = next;
+            visited.push_back(node);
+        }
+
+        nodes_[node].text = field;
+        for (const std::uint32_t live: visited)
+            nodes_[live].live = true;
+        return true;
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::reset()
+    {
+        parser_.reset();
+        stack_.clear();
+        pending_.clear();
+        pending_field_ = no_field;
+        record_depth_ = 0U;
+        attribute_ = no_field;
+    }
+
+    template <typename _Binding, typename _Config>
+    template <std::size_t _Index>
+    bool xpar_binder<_Binding, _Config>::store_field(const binding_t& binding, record_t& record, const char_t* text,
+                                                     const char_t* text_end, const bool first)
+    {
+        using member_t = typename std::tuple_element<_Index, typename binding_t::members_t>::type;
+        return store(std::get<_Index>(binding.members()), record, text, text_end, first, piecewise<member_t> {});
+    }
+
+    template <typename _Binding, typename _Config>
+    template <typename _Member>
+    bool xpar_binder<_Binding, _Config>::store(const _Member& member, record_t& record, const char_t* text, const char_t* text_end,
+                                               const bool first, std::true_type /*piecewise*/)
+    {
+        auto& value = record.*member.member;
+        if (first)
+            value.assign(text, text_end);
+        else
+            value.append(text, text_end);
+        return true;
+    }
+
+    template <typename _Binding, typename _Config>
+    template <typename _Member>
+    bool xpar_binder<_Binding, _Config>::store(const _Member& member, record_t& record, const char_t* text, const char_t* text_end,
+                                               const bool /*first*/, std::false_type /*piecewise*/)
+    {
+        return member.converter(text, text_end, record.*member.member);
+    }
+
+    template <typename _Binding, typename _Config>
+    std::uint32_t xpar_binder<_Binding, _Config>::child(const std::uint32_t node, const char_t* name, const char_t* name_end,
+                                                        const std::uint32_t hash) const noexcept
+    {
+        for (const std::uint32_t child: nodes_[node].children)
+        {
+            const auto& candidate = nodes_[child];
+            if ((candidate.hash == hash) && (candidate.name.size() == static_cast<std::size_t>(name_end - name)) &&
+                std::equal(name, name_end, candidate.name.data()))
+                return child;
+        }
+
+        return no_field;
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::write(const std::uint32_t field, const char_t* text, const char_t* text_end, const bool partial,
+                                               bool& stored)
+    {
+        const field_t& target = fields_[field];
+        record_t& record = (*records_)[records_->size() - 1U];
+        if (target.piecewise)
+        {
+            target.store(binding_, record, text, text_end, !stored);
+            stored = true;
+            return;
+        }
+
+        if (pending_field_ != field)
+            flush();
+        if (!partial && pending_.empty())
+        {
+            conversion_errors_ += target.store(binding_, record, text, text_end, true) ? 0U : 1U;
+            return;
+        }
+
+        pending_.append(text, text_end);
+        pending_field_ = field;
+        if (!partial)
+            flush();
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::flush()
+    {
+        // a value may end with a partial piece, the next event ends it then
+        if (pending_field_ == no_field)
+            return;
+
+        record_t& record = (*records_)[records_->size() - 1U];
+        const bool stored = fields_[pending_field_].store(binding_, record, pending_.data(), pending_.data() + pending_.size(), true);
+        conversion_errors_ += stored ? 0U : 1U;
+        pending_.clear();
+        pending_field_ = no_field;
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end)
+    {
+        flush();
+        const auto is = [name, name_end](const string_t& step)
+        { return (step.size() == static_cast<std::size_t>(name_end - name)) && std::equal(name, name_end, step.data()); };
+
+        if (record_depth_ != 0U)
+        {
+            const std::uint32_t parent = stack_.back().node;
+            const std::uint32_t node = (parent == skipped) ? no_field : child(parent, name, name_end, xpar_hash(name, name_end));
+            if ((node == no_field) || !nodes_[node].live)
+                parser.skip_element();
+            stack_.push_back({(node == no_field) ? std::uint32_t(skipped) : node, false});
+            return;
+        }
+
+        // outside records every open element is on the record path, but with "//name"
+        const std::size_t depth = stack_.size();
+        if (!valid_ || (!descendant_ && ((depth >= path_.size()) || !is(path_[depth]))))
+        {
+            parser.skip_element();
+            stack_.push_back({skipped, false});
+        }
+        else if ((descendant_ || (depth + 1U == path_.size())) && is(path_.back()))
+        {
+            records_->emplace_back();
+            stack_.push_back({0U, false});
+            record_depth_ = stack_.size();
+            if (!nodes_.front().live)
+                parser.skip_element();
+        }
+        else
+            stack_.push_back({outside, false});
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/)
+    {
+        if (stack_.empty()) [[unlikely]]
+            return;
+
+        flush();
+        if (stack_.size() == record_depth_)
+            record_depth_ = 0U;
+        stack_.pop_back();
+    }
+
+    template <typename _Binding, typename _Config>
+    bool xpar_binder<_Binding, _Config>::wanted_attribute(const xpar_t& /*parser*/, const std::uint32_t /*element*/,
+                                                          const std::uint32_t attribute) const noexcept
+    {
+        if (record_depth_ == 0U)
+            return false;
+
+        const std::uint32_t node = stack_.back().node;
+        for (const auto& candidate: attributes_)
+            if ((candidate.node == node) && (candidate.hash == attribute))
+                return true;
+        return false;
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        const std::uint32_t node = stack_.back().node;
+        flush();
+        attribute_ = no_field;
+        attribute_stored_ = false;
+        for (const auto& candidate: attributes_)
+            if ((candidate.node == node) && (candidate.name.size() == static_cast<std::size_t>(name_end - name)) &&
+                std::equal(name, name_end, candidate.name.data()))
+            {
+                attribute_ = candidate.field;
+                break;
+            }
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end,
+                                                            const bool partial)
+    {
+        if (attribute_ != no_field)
+            write(attribute_, text, text_end, partial, attribute_stored_);
+    }
+
+    template <typename _Binding, typename _Config>
+    void xpar_binder<_Binding, _Config>::on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (record_depth_ == 0U)
+            return;
+
+        entry_t& entry = stack_.back();
+        if ((entry.node != skipped) && (nodes_[entry.node].text != no_field))
+            write(nodes_[entry.node].text, text, text_end, partial, entry.text);
+    }
+}
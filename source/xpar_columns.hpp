@@ -0,0 +1,452 @@
+/// xpar_columns - Extraction of repeated records into typed columns with the Apache Arrow layout
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include "xpar_path.hpp"
+    #include "xpar_value.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <cstring>
+    #include <memory>
+    #include <string>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    enum class xpar_column_type : std::uint8_t
+    {
+        int32,
+        int64,
+        float64,
+        boolean,   // bit-packed values
+        utf8,      // int32 offsets and the characters, UTF-8 for char input
+        date32,    // days since 1970-01-01
+        timestamp, // int64 microseconds since 1970-01-01T00:00:00Z
+    };
+
+    /// Format string of the Arrow C data interface.
+    inline const char* xpar_arrow_format(const xpar_column_type type) noexcept
+    {
+        static const char* const formats[] = {"i", "l", "g", "b", "u", "tdD", "tsu:UTC"};
+        return formats[static_cast<std::size_t>(type)];
+    }
+
+    /// Contiguous bytes, 64-byte aligned and zero padded to a multiple of 64 bytes as Arrow recommends. The capacity grows by
+    /// doubling, at least by a block; the bytes resize() adds are zero.
+    class xpar_column_buffer
+    {
+    public:
+        enum constant : std::size_t
+        {
+            alignment = 64U,
+            block_size = 64U * 1024U,
+        };
+
+        std::uint8_t* data() noexcept { return data_; }
+        const std::uint8_t* data() const noexcept { return data_; }
+        std::size_t size() const noexcept { return size_; }
+        std::size_t capacity() const noexcept { return capacity_; }
+
+        void resize(const std::size_t size)
+        {
+            if (size > capacity_)
+                grow(size);
+            if (size > size_)
+                std::memset(data_ + size_, 0, size - size_);
+            size_ = size;
+        }
+
+        void append(const void* const data, const std::size_t size)
+        {
+            if (size_ + size > capacity_)
+                grow(size_ + size);
+            std::memcpy(data_ + size_, data, size);
+            size_ += size;
+        }
+
+        /// Keeps the memory.
+        void clear() noexcept
+        {
+            if (data_)
+                std::memset(data_, 0, size_);
+            size_ = 0U;
+        }
+
+    private:
+        void grow(const std::size_t size)
+        {
+            std::size_t capacity = std::max<std::size_t>(std::max<std::size_t>(capacity_ * 2U, block_size), size);
+            capacity = (capacity + alignment - 1U) & ~std::size_t(alignment - 1U);
+            std::unique_ptr<std::uint8_t[]> memory(new std::uint8_t[capacity + alignment]());
+            std::uint8_t* const data = memory.get() + (alignment - reinterpret_cast<std::uintptr_t>(memory.get()) % alignment) % alignment;
+            if (size_ != 0U)
+                std::memcpy(data, data_, size_);
+            memory_ = std::move(memory);
+            data_ = data;
+            capacity_ = capacity;
+        }
+
+        std::unique_ptr<std::uint8_t[]> memory_ {};
+        std::uint8_t* data_ {};
+        std::size_t size_ {};
+        std::size_t capacity_ {};
+    };
+
+    /// One column with the Arrow buffers: the validity bitmap (bit i of byte i / 8 set for a value, clear for a null), the values,
+    /// fixed width or bit-packed for boolean, and for utf8 the length + 1 offsets of the values into data().
+    class xpar_column
+    {
+    public:
+        xpar_column(const xpar_column_type type): type_(type) { clear(); }
+
+        xpar_column_type type() const noexcept { return type_; }
+        std::size_t length() const noexcept { return length_; }
+        std::size_t null_count() const noexcept { return null_count_; }
+
+        const std::uint8_t* validity() const noexcept { return validity_.data(); }
+        const std::uint8_t* values() const noexcept { return values_.data(); }
+        const std::int32_t* offsets() const noexcept { return reinterpret_cast<const std::int32_t*>(values_.data()); }
+        const std::uint8_t* data() const noexcept { return data_.data(); }
+        std::size_t data_size() const noexcept { return data_.size(); }
+
+        template <typename _Value>
+        const _Value* values_as() const noexcept
+        {
+            return reinterpret_cast<const _Value*>(values_.data());
+        }
+
+        bool valid(const std::size_t row) const noexcept { return ((validity_.data()[row / 8U] >> (row % 8U)) & 1U) != 0U; }
+
+        void clear() noexcept;
+
+        /// Adds a null row, set_value or append_text fill it.
+        void add_row();
+        /// Ends the last row, counts it if it stayed null.
+        void end_row();
+
+        template <typename _Char>
+        bool set_value(const _Char* text, const _Char* text_end);
+        template <typename _Char>
+        void append_text(const _Char* text, const _Char* text_end);
+
+    private:
+        template <typename _Value>
+        void store(const _Value value) noexcept
+        {
+            std::memcpy(values_.data() + (length_ - 1U) * sizeof(_Value), &value, sizeof(_Value));
+        }
+
+        void set_valid() noexcept { validity_.data()[(length_ - 1U) / 8U] |= static_cast<std::uint8_t>(1U << ((length_ - 1U) % 8U)); }
+
+        xpar_column_type type_;
+        xpar_column_buffer validity_ {};
+        xpar_column_buffer values_ {}; // the offsets for utf8
+        xpar_column_buffer data_ {};
+        std::size_t length_ {};
+        std::size_t null_count_ {};
+    };
+
+    inline void xpar_column::clear() noexcept
+    {
+        validity_.clear();
+        values_.clear();
+        data_.clear();
+        length_ = 0U;
+        null_count_ = 0U;
+        if (type_ == xpar_column_type::utf8)
+            values_.resize(sizeof(std::int32_t));
+    }
+
+    inline void xpar_column::add_row()
+    {
+        static const std::uint8_t widths[] = {4U, 8U, 8U, 0U, 0U, 4U, 8U};
+        ++length_;
+        validity_.resize((length_ + 7U) / 8U);
+        if (type_ == xpar_column_type::boolean)
+            values_.resize((length_ + 7U) / 8U);
+        else if (type_ != xpar_column_type::utf8)
+            values_.resize(length_ * widths[static_cast<std::size_t>(type_)]);
+    }
+
+    inline void xpar_column::end_row()
+    {
+        if (type_ == xpar_column_type::utf8)
+        {
+            const std::int32_t offset = static_cast<std::int32_t>(data_.size());
+            values_.append(&offset, sizeof(offset));
+        }
+
+        null_count_ += valid(length_ - 1U) ? 0U : 1U;
+    }
+
+    template <typename _Char>
+    bool xpar_column::set_value(const _Char* text, const _Char* text_end)
+    {
+        switch (type_)
+        {
+            case xpar_column_type::int32:
+            {
+                std::int32_t value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                store(value);
+                break;
+            }
+            case xpar_column_type::int64:
+            {
+                std::int64_t value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                store(value);
+                break;
+            }
+            case xpar_column_type::float64:
+            {
+                double value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                store(value);
+                break;
+            }
+            case xpar_column_type::boolean:
+            {
+                bool value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                if (value)
+                    values_.data()[(length_ - 1U) / 8U] |= static_cast<std::uint8_t>(1U << ((length_ - 1U) % 8U));
+                break;
+            }
+            case xpar_column_type::utf8:
+                append_text(text, text_end);
+                break;
+            case xpar_column_type::date32:
+            {
+                xpar_date_time value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                store(static_cast<std::int32_t>(value.days()));
+                break;
+            }
+            case xpar_column_type::timestamp:
+            {
+                xpar_date_time value;
+                if (!xpar_parse(text, text_end, value))
+                    return false;
+                store(value.seconds() * 1000000 + value.nanosecond / 1000U);
+                break;
+            }
+        }
+
+        set_valid();
+        return true;
+    }
+
+    template <typename _Char>
+    void xpar_column::append_text(const _Char* text, const _Char* text_end)
+    {
+        data_.append(text, (text_end - text) * sizeof(_Char));
+        set_valid();
+    }
+
+    /// Fills a column per field of the records a path selects, e.g. the record "/codeBook/dataDscr/var" and the fields "@name",
+    /// "location/@width" and "labl": a field is an attribute of the record or the text or an attribute of a descendant, as in
+    /// xpar_path_filter. A row gets the first value of each field, a missing field or a value not in the lexical space of its
+    /// column type makes a null. The columns keep their memory through reset(), batches may be read and reset one after the other.
+    template <typename _Config = xpar_default_config>
+    class xpar_column_extractor
+    {
+    public:
+        using config_t = _Config;
+        using filter_t = xpar_path_filter<xpar_column_extractor, _Config>;
+        using xpar_t = typename filter_t::xpar_t;
+        using char_t = typename filter_t::char_t;
+        using string_t = std::basic_string<char_t>;
+
+        enum constant : std::uint32_t
+        {
+            invalid_column = 0xFFFFFFFFU,
+        };
+
+        /// Sets the record path before the fields, returns false if it is not a valid element path.
+        bool set_record(const char_t* path, const char_t* path_end);
+        /// Adds a field relative to the record, returns the column index or invalid_column.
+        std::uint32_t add_column(const char_t* path, const char_t* path_end, const xpar_column_type type);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { filter_(buffer, buffer_size); }
+
+        std::size_t rows() const noexcept { return rows_; }
+        std::size_t column_count() const noexcept { return columns_.size(); }
+        const xpar_column& column(const std::size_t index) const noexcept { return columns_[index]; }
+        std::size_t conversion_errors() const noexcept { return conversion_errors_; }
+
+        filter_t& filter() noexcept { return filter_; }
+        xpar_t& parser() noexcept { return filter_.parser(); }
+
+        /// Restarts the parsing with empty columns.
+        void reset();
+
+        void on_element_begin(filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end);
+        void on_element_end(filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end);
+        void on_attribute(filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end, const char_t* value,
+                          const char_t* value_end);
+        void on_data(filter_t& filter, const std::uint32_t path, const char_t* text, const char_t* text_end, const bool partial);
+        void on_error(filter_t& /*filter*/, bool& /*try_continue*/) {}
+
+    protected:
+        enum class field_state_t : std::uint8_t
+        {
+            empty,
+            reading, // the field element is open
+            done,
+        };
+
+        struct field_t
+        {
+            std::uint32_t column;
+            field_state_t state;
+            string_t pending; // a value split by the buffers, converted at the element end
+        };
+
+        void set_value(field_t& field, const char_t* text, const char_t* text_end);
+
+        filter_t filter_ {this};
+        string_t record_ {};
+        std::uint32_t record_path_ {filter_t::invalid_path};
+        std::vector<xpar_column> columns_ {};
+        std::vector<field_t> fields_ {}; // by path id, the record path has none
+        std::size_t rows_ {};
+        std::size_t records_open_ {}; // nested records belong to the outermost one
+        std::size_t conversion_errors_ {};
+    };
+
+    template <typename _Config>
+    bool xpar_column_extractor<_Config>::set_record(const char_t* path, const char_t* path_end)
+    {
+        if ((record_path_ != filter_t::invalid_path) || (std::find(path, path_end, char_t('@')) != path_end))
+            return false;
+
+        record_path_ = filter_.subscribe(path, path_end, false);
+        if (record_path_ == filter_t::invalid_path)
+            return false;
+
+        record_.assign(path, path_end);
+        fields_.resize(record_path_ + 1U, {invalid_column, field_state_t::empty, {}});
+        return true;
+    }
+
+    template <typename _Config>
+    std::uint32_t xpar_column_extractor<_Config>::add_column(const char_t* path, const char_t* path_end, const xpar_column_type type)
+    {
+        if ((record_path_ == filter_t::invalid_path) || (path == path_end) || (*path == '/'))
+            return invalid_column;
+
+        string_t full = record_;
+        full += char_t('/');
+        full.append(path, path_end);
+        const std::uint32_t id = filter_.subscribe(full.data(), full.data() + full.size());
+        if (id == filter_t::invalid_path)
+            return invalid_column;
+
+        const std::uint32_t column = static_cast<std::uint32_t>(columns_.size());
+        columns_.emplace_back(type);
+        fields_.resize(id + 1U, {invalid_column, field_state_t::empty, {}});
+        fields_[id].column = column;
+        return column;
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::reset()
+    {
+        filter_.reset();
+        for (auto& column: columns_)
+            column.clear();
+        for (auto& field: fields_)
+        {
+            field.state = field_state_t::empty;
+            field.pending.clear();
+        }
+
+        rows_ = 0U;
+        records_open_ = 0U;
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::set_value(field_t& field, const char_t* text, const char_t* text_end)
+    {
+        field.state = field_state_t::done;
+        conversion_errors_ += columns_[field.column].set_value(text, text_end) ? 0U : 1U;
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::on_element_begin(filter_t& /*filter*/, const std::uint32_t path, const char_t* /*name*/,
+                                                          const char_t* /*name_end*/)
+    {
+        if (path == record_path_)
+        {
+            if (records_open_++ != 0U)
+                return;
+
+            ++rows_;
+            for (auto& column: columns_)
+                column.add_row();
+            for (auto& field: fields_)
+                field.state = field_state_t::empty;
+            return;
+        }
+
+        field_t& field = fields_[path];
+        if ((records_open_ != 0U) && (field.state == field_state_t::empty))
+        {
+            // an empty element is an empty text
+            field.state = field_state_t::reading;
+            field.pending.clear();
+        }
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::on_element_end(filter_t& /*filter*/, const std::uint32_t path, const char_t* /*name*/,
+                                                        const char_t* /*name_end*/)
+    {
+        if (path == record_path_)
+        {
+            if (--records_open_ == 0U)
+                for (auto& column: columns_)
+                    column.end_row();
+            return;
+        }
+
+        field_t& field = fields_[path];
+        if (field.state == field_state_t::reading)
+            set_value(field, field.pending.data(), field.pending.data() + field.pending.size());
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::on_attribute(filter_t& /*filter*/, const std::uint32_t path, const char_t* /*name*/,
+                                                      const char_t* /*name_end*/, const char_t* value, const char_t* value_end)
+    {
+        field_t& field = fields_[path];
+        if ((records_open_ != 0U) && (field.state == field_state_t::empty))
+            set_value(field, value, value_end);
+    }
+
+    template <typename _Config>
+    void xpar_column_extractor<_Config>::on_data(filter_t& /*filter*/, const std::uint32_t path, const char_t* text, const char_t* text_end,
+                                                 const bool partial)
+    {
+        field_t& field = fields_[path];
+        if (field.state != field_state_t::reading)
+            return;
+
+        xpar_column& column = columns_[field.column];
+        if (column.type() == xpar_column_type::utf8)
+            column.append_text(text, text_end);
+        else if (!partial && field.pending.empty())
+            set_value(field, text, text_end);
+        else
+            field.pending.append(text, text_end);
+    }
+}
@@ -0,0 +1,658 @@
+/// xpar_dfa - Table driven XML tokenizer with the xpar observer interface
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <array>
+    #include <cstdint>
+    #include <cstring>
+#endif
+
+namespace stdext
+{
+    namespace xpar_detail
+    {
+        enum dfa_class : std::uint8_t
+        {
+            c_other,
+            c_space,
+            c_lt,
+            c_gt,
+            c_slash,
+            c_eq,
+            c_dquote,
+            c_squote,
+            c_bang,
+            c_question,
+            c_dash,
+            c_name_start,
+            c_name_char,
+            c_lbracket,
+            c_rbracket,
+            dfa_class_count
+        };
+
+        enum dfa_state : std::uint8_t
+        {
+            s_content,
+            s_text,
+            s_lt,
+            s_stag_name,
+            s_tag,
+            s_attr_name,
+            s_attr_after_name,
+            s_attr_eq,
+            s_value_d,
+            s_value_s,
+            s_empty,
+            s_etag_start,
+            s_etag_name,
+            s_etag_after_name,
+            s_bang,
+            s_bang_dash,
+            s_comment,
+            s_comment_dash,
+            s_comment_dash2,
+            s_pi,
+            s_pi_q,
+            s_doctype,
+            s_doctype_subset,
+            s_cdata_open,
+            s_cdata,
+            s_cdata_bracket,
+            s_cdata_bracket2,
+            s_error,
+            dfa_state_count
+        };
+
+        enum dfa_action : std::uint8_t
+        {
+            a_none,
+            a_text_begin,
+            a_text_end,
+            a_name_begin,
+            a_element_begin,
+            a_element_end,
+            a_empty_element_end,
+            a_attribute,
+            a_value_begin,
+            a_value_end,
+            a_comment_begin,
+            a_comment_dashes,
+            a_comment_end,
+            a_cdata_match,
+            a_cdata_brackets,
+            a_cdata_end,
+            a_error,
+        };
+
+        /// Transitions are (action << 8 | next state); the unlisted bytes of a state lead to s_error.
+        struct dfa_table
+        {
+            std::uint8_t classes[256];
+            std::uint16_t transitions[dfa_state_count][dfa_class_count];
+        };
+
+        constexpr std::uint16_t dfa_to(const dfa_state state, const dfa_action action = a_none)
+        {
+            return static_cast<std::uint16_t>((action << 8) | state);
+        }
+
+        constexpr dfa_table make_dfa_table()
+        {
+            dfa_table table {};
+            for (unsigned i = 0U; i != 256U; ++i)
+                table.classes[i] = (((i >= 'a') && (i <= 'z')) || ((i >= 'A') && (i <= 'Z')) || (i == '_') || (i == ':') || (i >= 0x80U))
+                                       ? c_name_start
+                                   : (((i >= '0') && (i <= '9')) || (i == '.')) ? c_name_char
+                                                                                 : c_other;
+            table.classes[' '] = table.classes['\t'] = table.classes['\r'] = table.classes['\n'] = table.classes['\v'] = c_space;
+            table.classes['<'] = c_lt;
+            table.classes['>'] = c_gt;
+            table.classes['/'] = c_slash;
+            table.classes['='] = c_eq;
+            table.classes['"'] = c_dquote;
+            table.classes['\''] = c_squote;
+            table.classes['!'] = c_bang;
+            table.classes['?'] = c_question;
+            table.classes['-'] = c_dash;
+            table.classes['['] = c_lbracket;
+            table.classes[']'] = c_rbracket;
+
+            for (unsigned state = 0U; state != dfa_state_count; ++state)
+                for (unsigned item = 0U; item != dfa_class_count; ++item)
+                    table.transitions[state][item] = dfa_to(s_error, a_error);
+
+            for (unsigned item = 0U; item != dfa_class_count; ++item)
+            {
+                table.transitions[s_content][item] = dfa_to(s_text, a_text_begin);
+                table.transitions[s_text][item] = dfa_to(s_text);
+                table.transitions[s_value_d][item] = dfa_to(s_value_d);
+                table.transitions[s_value_s][item] = dfa_to(s_value_s);
+                table.transitions[s_bang][item] = dfa_to(s_doctype);
+                table.transitions[s_comment][item] = dfa_to(s_comment);
+                table.transitions[s_comment_dash][item] = dfa_to(s_comment, a_comment_dashes);
+                table.transitions[s_comment_dash2][item] = dfa_to(s_comment, a_comment_dashes);
+                table.transitions[s_pi][item] = dfa_to(s_pi);
+                table.transitions[s_pi_q][item] = dfa_to(s_pi);
+                table.transitions[s_doctype][item] = dfa_to(s_doctype);
+                table.transitions[s_doctype_subset][item] = dfa_to(s_doctype_subset);
+                table.transitions[s_cdata_open][item] = dfa_to(s_cdata_open, a_cdata_match);
+                table.transitions[s_cdata][item] = dfa_to(s_cdata);
+                table.transitions[s_cdata_bracket][item] = dfa_to(s_cdata, a_cdata_brackets);
+                table.transitions[s_cdata_bracket2][item] = dfa_to(s_cdata, a_cdata_brackets);
+                table.transitions[s_error][item] = dfa_to(s_error);
+            }
+
+            // only reached on error recovery
+            table.transitions[s_error][c_lt] = dfa_to(s_lt);
+
+            table.transitions[s_content][c_space] = dfa_to(s_content);
+            table.transitions[s_content][c_lt] = dfa_to(s_lt);
+            table.transitions[s_text][c_lt] = dfa_to(s_lt, a_text_end);
+
+            table.transitions[s_lt][c_name_start] = dfa_to(s_stag_name, a_name_begin);
+            table.transitions[s_lt][c_slash] = dfa_to(s_etag_start);
+            table.transitions[s_lt][c_bang] = dfa_to(s_bang);
+            table.transitions[s_lt][c_question] = dfa_to(s_pi);
+
+            table.transitions[s_stag_name][c_name_start] = table.transitions[s_stag_name][c_name_char] =
+                table.transitions[s_stag_name][c_dash] = dfa_to(s_stag_name);
+            table.transitions[s_stag_name][c_space] = dfa_to(s_tag, a_element_begin);
+            table.transitions[s_stag_name][c_gt] = dfa_to(s_content, a_element_begin);
+            table.transitions[s_stag_name][c_slash] = dfa_to(s_empty, a_element_begin);
+
+            table.transitions[s_tag][c_space] = dfa_to(s_tag);
+            table.transitions[s_tag][c_name_start] = dfa_to(s_attr_name, a_name_begin);
+            table.transitions[s_tag][c_gt] = dfa_to(s_content);
+            table.transitions[s_tag][c_slash] = dfa_to(s_empty);
+
+            table.transitions[s_attr_name][c_name_start] = table.transitions[s_attr_name][c_name_char] =
+                table.transitions[s_attr_name][c_dash] = dfa_to(s_attr_name);
+            table.transitions[s_attr_name][c_space] = dfa_to(s_attr_after_name, a_attribute);
+            table.transitions[s_attr_name][c_eq] = dfa_to(s_attr_eq, a_attribute);
+            table.transitions[s_attr_after_name][c_space] = dfa_to(s_attr_after_name);
+            table.transitions[s_attr_after_name][c_eq] = dfa_to(s_attr_eq);
+            table.transitions[s_attr_eq][c_space] = dfa_to(s_attr_eq);
+            table.transitions[s_attr_eq][c_dquote] = dfa_to(s_value_d, a_value_begin);
+            table.transitions[s_attr_eq][c_squote] = dfa_to(s_value_s, a_value_begin);
+            table.transitions[s_value_d][c_dquote] = dfa_to(s_tag, a_value_end);
+            table.transitions[s_value_s][c_squote] = dfa_to(s_tag, a_value_end);
+
+            table.transitions[s_empty][c_gt] = dfa_to(s_content, a_empty_element_end);
+
+            table.transitions[s_etag_start][c_name_start] = dfa_to(s_etag_name, a_name_begin);
+            table.transitions[s_etag_name][c_name_start] = table.transitions[s_etag_name][c_name_char] =
+                table.transitions[s_etag_name][c_dash] = dfa_to(s_etag_name);
+            table.transitions[s_etag_name][c_space] = dfa_to(s_etag_after_name, a_element_end);
+            table.transitions[s_etag_name][c_gt] = dfa_to(s_content, a_element_end);
+            table.transitions[s_etag_after_name][c_space] = dfa_to(s_etag_after_name);
+            table.transitions[s_etag_after_name][c_gt] = dfa_to(s_content);
+
+            table.transitions[s_bang][c_dash] = dfa_to(s_bang_dash);
+            table.transitions[s_bang][c_lbracket] = dfa_to(s_cdata_open);
+            table.transitions[s_bang_dash][c_dash] = dfa_to(s_comment, a_comment_begin);
+            table.transitions[s_comment][c_dash] = dfa_to(s_comment_dash);
+            table.transitions[s_comment_dash][c_dash] = dfa_to(s_comment_dash2);
+            table.transitions[s_comment_dash2][c_dash] = dfa_to(s_comment_dash2);
+            table.transitions[s_comment_dash2][c_gt] = dfa_to(s_content, a_comment_end);
+
+            table.transitions[s_pi][c_question] = dfa_to(s_pi_q);
+            table.transitions[s_pi_q][c_question] = dfa_to(s_pi_q);
+            table.transitions[s_pi_q][c_gt] = dfa_to(s_content);
+
+            table.transitions[s_doctype][c_lbracket] = dfa_to(s_doctype_subset);
+            table.transitions[s_doctype][c_gt] = dfa_to(s_content);
+            table.transitions[s_doctype_subset][c_rbracket] = dfa_to(s_doctype);
+
+            // "CDATA[" is matched by a_cdata_match, which moves to s_cdata or, for any other "<![", to s_doctype
+            table.transitions[s_cdata][c_rbracket] = dfa_to(s_cdata_bracket);
+            table.transitions[s_cdata_bracket][c_rbracket] = dfa_to(s_cdata_bracket2);
+            table.transitions[s_cdata_bracket2][c_rbracket] = dfa_to(s_cdata_bracket2);
+            table.transitions[s_cdata_bracket2][c_gt] = dfa_to(s_content, a_cdata_end);
+            return table;
+        }
+
+        constexpr dfa_table dfa = make_dfa_table();
+    }
+
+    /// Alternative engine: every byte goes through a class table and a (state, class) transition table generated at compile time,
+    /// the observer callbacks fire on the marked transitions only. Names and values are delivered from the input buffer, or from
+    /// an internal copy when they span two buffers; comments and CDATA sections are delivered without their delimiters, the
+    /// sections through on_cdata or, when the observer has none, on_data.
+    /// DOCTYPE internal subsets are skipped up to the first ']' and positions are computed on request as with track_position = 0.
+    /// Text, attribute values, comments and CDATA sections go to their next delimiter with find instead of byte by byte.
+    /// On error recovery a malformed or too long token is skipped up to the next '<'; the depth limit stops the parsing.
+    /// The engine is slower than xpar's switch (about 1.4 times on nes96) and is kept as an independent tokenizer the tests
+    /// compare xpar with.
+    template <typename _Observer, typename _Config = xpar_default_config>
+    class xpar_dfa
+    {
+    public:
+        using uint_t = unsigned;
+        using config_t = _Config;
+        using char_t = typename _Config::char_t;
+        using observer_t = _Observer;
+        using options_t = xpar_options<_Config>;
+        using traits_t = xpar_observer_traits<_Observer, xpar_dfa>;
+
+        static_assert(sizeof(char_t) == 1U, "xpar_dfa works on bytes");
+
+        enum class error_t
+        {
+            none,
+            elem_end_not_match,
+            unexpected_char,
+            unterminated_comment,
+            max_elem_name_length_exceeded,
+            max_attr_name_length_exceeded,
+            max_attr_value_length_exceeded,
+            max_stack_size_exceeded, // more than max_stack_size - 1 open elements, parsing stops
+        };
+
+        constexpr xpar_dfa(observer_t* const observer) noexcept: observer_(observer) {}
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size);
+
+        uint_t line() const noexcept { return line_ + static_cast<uint_t>(xpar_detail::count(begin_, ptr_, char_t('\n'))); }
+        uint_t column() const noexcept;
+        error_t error() const noexcept { return error_; }
+        std::uint64_t offset() const noexcept { return base_offset_ + static_cast<std::uint64_t>(ptr_ - begin_); }
+
+        uint_t stack_size() const noexcept { return depth_; }
+        const char_t* stack_value(const uint_t index) const noexcept;
+
+        observer_t* observer() const noexcept { return observer_; }
+        void set_observer(observer_t* const observer) noexcept { observer_ = observer; }
+
+        void reset() noexcept;
+
+    protected:
+        using carry_buffer_t = std::array<char_t, config_t::max_value_length>;
+        using stack_buffer_t = std::array<char_t, config_t::max_stack_size * config_t::max_name_length>;
+
+        void act(const xpar_detail::dfa_action action);
+        const char_t* next_delimiter(const char_t* from) const noexcept;
+        bool carry(const char_t* end);
+        bool token(const char_t*& token_begin, const char_t*& token_end);
+        bool fail(const error_t error);
+        void report_cdata(const char_t* text, const char_t* text_end, const bool partial);
+
+        stack_buffer_t stack_buffer_ {};
+        carry_buffer_t carry_buffer_ {};
+        const char_t* ptr_ {};
+        const char_t* begin_ {};
+        const char_t* end_ {};
+        const char_t* mark_ {};
+        observer_t* observer_;
+        std::uint64_t base_offset_ {};
+        std::size_t carry_size_ {};
+        uint_t line_ {1U};
+        uint_t column_base_ {};
+        uint_t depth_ {};
+        uint_t pending_ {}; // the dashes or brackets held back at a buffer end
+        uint_t matched_ {}; // the length of "CDATA[" matched
+        std::uint8_t state_ {xpar_detail::s_content};
+        error_t error_ {};
+        bool carried_ {};
+    };
+
+    template <typename _Observer, typename _Config>
+    void xpar_dfa<_Observer, _Config>::operator()(const char_t* buffer, const std::size_t buffer_size)
+    {
+        using namespace xpar_detail;
+        base_offset_ += static_cast<std::uint64_t>(end_ - begin_);
+        begin_ = buffer;
+        end_ = buffer + buffer_size;
+        mark_ = buffer;
+        if (error_ != error_t::none)
+            return;
+
+        std::uint8_t state = state_;
+        for (ptr_ = next_delimiter(buffer); ptr_ != end_; ++ptr_)
+        {
+            const std::uint16_t transition = dfa.transitions[state][dfa.classes[static_cast<std::uint8_t>(*ptr_)]];
+            state = static_cast<std::uint8_t>(transition);
+            if (transition > 0xFFU) [[unlikely]]
+            {
+                state_ = state;
+                act(static_cast<dfa_action>(transition >> 8));
+                if (error_ != error_t::none) [[unlikely]]
+                    return;
+                state = state_;
+
+                // the text, value, comment and CDATA states go to their next delimiter at once
+                ptr_ = next_delimiter(ptr_ + 1) - 1;
+            }
+        }
+
+        state_ = state;
+        switch (state)
+        {
+            case s_text:
+                if (mark_ != end_)
+                    xpar_detail::call_if(typename traits_t::on_data {}, *observer_,
+                                         [this](auto& observer) { observer.on_data(*this, mark_, end_, true); });
+                break;
+            case s_comment:
+            case s_comment_dash:
+            case s_comment_dash2:
+            {
+                // hold back the trailing dashes, they may start the comment end
+                const uint_t dashes = (state == s_comment) ? 0U : (state == s_comment_dash) ? 1U : 2U;
+                const char_t* const text_end = std::max(mark_, end_ - (dashes - pending_));
+                if (text_end != mark_)
+                    xpar_detail::call_if(typename traits_t::on_comment {}, *observer_,
+                                         [&](auto& observer) { observer.on_comment(*this, mark_, text_end, true); });
+                pending_ = dashes;
+                break;
+            }
+            case s_cdata:
+            case s_cdata_bracket:
+            case s_cdata_bracket2:
+            {
+                // the same for the brackets, they may start the section end
+                const uint_t brackets = (state == s_cdata) ? 0U : (state == s_cdata_bracket) ? 1U : 2U;
+                const char_t* const text_end = std::max(mark_, end_ - (brackets - pending_));
+                if (text_end != mark_)
+                    report_cdata(mark_, text_end, true);
+                pending_ = brackets;
+                break;
+            }
+            case s_stag_name:
+            case s_etag_name:
+            case s_attr_name:
+            case s_value_d:
+            case s_value_s:
+                carry(end_);
+                break;
+            default:
+                break;
+        }
+
+        const char_t* line_begin = ptr_;
+        while ((line_begin != begin_) && (line_begin[-1] != '\n'))
+            --line_begin;
+        line_ += static_cast<uint_t>(xpar_detail::count(begin_, ptr_, char_t('\n')));
+        column_base_ = static_cast<uint_t>((line_begin != begin_) ? ptr_ - line_begin : column_base_ + (ptr_ - begin_));
+        base_offset_ += static_cast<std::uint64_t>(end_ - begin_);
+        begin_ = end_;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_dfa<_Observer, _Config>::act(const xpar_detail::dfa_action action)
+    {
+        using namespace xpar_detail;
+        const char_t* token_begin;
+        const char_t* token_end;
+        switch (action)
+        {
+            case a_text_begin:
+            case a_name_begin:
+                mark_ = ptr_;
+                break;
+            case a_value_begin:
+            case a_comment_begin:
+                mark_ = ptr_ + 1;
+                break;
+            case a_text_end:
+                if (ptr_ != mark_)
+                    xpar_detail::call_if(typename traits_t::on_data {}, *observer_,
+                                         [this](auto& observer) { observer.on_data(*this, mark_, ptr_, false); });
+                break;
+            case a_element_begin:
+                if (!token(token_begin, token_end))
+                    break;
+                if (depth_ + 1U >= config_t::max_stack_size) [[unlikely]]
+                {
+                    // the element cannot be tracked, there is no recovery
+                    fail(error_t::max_stack_size_exceeded);
+                    error_ = error_t::max_stack_size_exceeded;
+                    break;
+                }
+                if (token_end - token_begin > config_t::max_name_length) [[unlikely]]
+                {
+                    // on recovery the start tag is left out and the input skipped up to the next '<'
+                    if (fail(error_t::max_elem_name_length_exceeded))
+                        state_ = s_error;
+                    break;
+                }
+
+                ++depth_;
+                std::memcpy(stack_buffer_.data() + depth_ * config_t::max_name_length, token_begin, token_end - token_begin);
+                if (token_end - token_begin != config_t::max_name_length)
+                    stack_buffer_[depth_ * config_t::max_name_length + (token_end - token_begin)] = {};
+                xpar_detail::call_if(typename traits_t::on_element_begin {}, *observer_,
+                                     [&](auto& observer) { observer.on_element_begin(*this, token_begin, token_end); });
+                break;
+            case a_element_end:
+            {
+                if (!token(token_begin, token_end))
+                    break;
+                const char_t* const name = stack_value(depth_);
+                const std::size_t length = token_end - token_begin;
+                if ((depth_ == 0U) || (length > config_t::max_name_length) || (std::memcmp(name, token_begin, length) != 0) ||
+                    ((length != config_t::max_name_length) && (name[length] != char_t {}))) [[unlikely]]
+                {
+                    // on recovery the open element is closed, as with xpar, unless the name is too long to be any of them
+                    if (fail(error_t::elem_end_not_match) && (depth_ != 0U) && (length <= config_t::max_name_length))
+                        --depth_;
+                    break;
+                }
+
+                --depth_;
+                xpar_detail::call_if(typename traits_t::on_element_end {}, *observer_,
+                                     [&](auto& observer) { observer.on_element_end(*this, token_begin, token_end); });
+                break;
+            }
+            case a_empty_element_end:
+            {
+                const char_t* const name = stack_value(depth_--);
+                const char_t* const name_end = std::find(name, name + config_t::max_name_length, char_t {});
+                xpar_detail::call_if(typename traits_t::on_element_end {}, *observer_,
+                                     [&](auto& observer) { observer.on_element_end(*this, name, name_end); });
+                break;
+            }
+            case a_attribute:
+                if (!token(token_begin, token_end))
+                    break;
+                xpar_detail::call_if(typename traits_t::on_attribute {}, *observer_,
+                                     [&](auto& observer) { observer.on_attribute(*this, token_begin, token_end); });
+                break;
+            case a_value_end:
+                if (!token(token_begin, token_end))
+                    break;
+                xpar_detail::call_if(typename traits_t::on_attribute_value {}, *observer_,
+                                     [&](auto& observer) { observer.on_attribute_value(*this, token_begin, token_end, false); });
+                break;
+            case a_comment_dashes:
+                if (pending_ != 0U)
+                {
+                    static const char_t dashes[] = {'-', '-'};
+                    xpar_detail::call_if(typename traits_t::on_comment {}, *observer_,
+                                         [this](auto& observer) { observer.on_comment(*this, dashes, dashes + pending_, true); });
+                    pending_ = 0U;
+                }
+                break;
+            case a_comment_end:
+            {
+                const char_t* const text_end = std::max(mark_, ptr_ - 2);
+                pending_ = 0U;
+                xpar_detail::call_if(typename traits_t::on_comment {}, *observer_,
+                                     [&](auto& observer) { observer.on_comment(*this, mark_, text_end, false); });
+                break;
+            }
+            case a_cdata_match:
+            {
+                static constexpr char opening[] = "CDATA[";
+                if (*ptr_ != static_cast<char_t>(opening[matched_]))
+                {
+                    // any other "<![" is skipped as a declaration
+                    matched_ = 0U;
+                    state_ = static_cast<std::uint8_t>(dfa.transitions[s_doctype][dfa.classes[static_cast<std::uint8_t>(*ptr_)]]);
+                }
+                else if (++matched_ == sizeof(opening) - 1U)
+                {
+                    matched_ = 0U;
+                    pending_ = 0U;
+                    mark_ = ptr_ + 1;
+                    state_ = s_cdata;
+                }
+                break;
+            }
+            case a_cdata_brackets:
+                if (pending_ != 0U)
+                {
+                    static const char_t brackets[] = {']', ']'};
+                    report_cdata(brackets, brackets + pending_, true);
+                    pending_ = 0U;
+                }
+                break;
+            case a_cdata_end:
+            {
+                // the brackets before the "]]>" are content, some of them may be held from the previous buffer
+                static const char_t brackets[] = {']', ']'};
+                const std::size_t held = std::min<std::size_t>(pending_, ptr_ - mark_ < 2 ? 2 - (ptr_ - mark_) : 0U);
+                if (pending_ > held)
+                    report_cdata(brackets, brackets + pending_ - held, true);
+                pending_ = 0U;
+                report_cdata(mark_, std::max(mark_, ptr_ - 2), false);
+                break;
+            }
+            case a_error:
+                // on recovery the input is skipped up to the next '<'
+                if (fail(error_t::unexpected_char))
+                    state_ = (*ptr_ == '<') ? s_lt : s_error;
+                break;
+            default:
+                break;
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    const typename xpar_dfa<_Observer, _Config>::char_t* xpar_dfa<_Observer, _Config>::next_delimiter(const char_t* from) const noexcept
+    {
+        using namespace xpar_detail;
+        switch (state_)
+        {
+            case s_text:
+                return xpar_detail::find(from, end_, char_t('<'));
+            case s_value_d:
+                return xpar_detail::find(from, end_, char_t('"'));
+            case s_value_s:
+                return xpar_detail::find(from, end_, char_t('\''));
+            case s_comment:
+                return xpar_detail::find(from, end_, char_t('-'));
+            case s_cdata:
+                return xpar_detail::find(from, end_, char_t(']'));
+            default:
+                return from;
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_dfa<_Observer, _Config>::carry(const char_t* end)
+    {
+        const std::size_t size = end - mark_;
+        if (carry_size_ + size > carry_buffer_.size()) [[unlikely]]
+        {
+            // on recovery the token is dropped and the input skipped up to the next '<'
+            ptr_ = end;
+            const auto state = state_;
+            carry_size_ = 0U;
+            carried_ = false;
+            if (fail(((state == xpar_detail::s_value_d) || (state == xpar_detail::s_value_s)) ? error_t::max_attr_value_length_exceeded
+                     : (state == xpar_detail::s_attr_name)                                     ? error_t::max_attr_name_length_exceeded
+                                                                                               : error_t::max_elem_name_length_exceeded))
+                state_ = xpar_detail::s_error;
+            return false;
+        }
+
+        std::memcpy(carry_buffer_.data() + carry_size_, mark_, size);
+        carry_size_ += size;
+        carried_ = true;
+        return true;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_dfa<_Observer, _Config>::token(const char_t*& token_begin, const char_t*& token_end)
+    {
+        if (!carried_) [[likely]]
+        {
+            token_begin = mark_;
+            token_end = ptr_;
+            return true;
+        }
+
+        // the token started in a previous buffer
+        if (!carry(ptr_))
+            return false;
+
+        token_begin = carry_buffer_.data();
+        token_end = carry_buffer_.data() + carry_size_;
+        carry_size_ = 0U;
+        carried_ = false;
+        return true;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_dfa<_Observer, _Config>::fail(const error_t error)
+    {
+        // returns true when the observer asks to continue and the config allows it
+        error_ = error;
+        bool try_continue = config_t::try_continue_on_error;
+        xpar_detail::call_if(typename traits_t::on_error {}, *observer_, [&](auto& observer) { observer.on_error(*this, try_continue); });
+        if (!options_t::error_recovery || !try_continue)
+            return false;
+
+        error_ = error_t::none;
+        return true;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_dfa<_Observer, _Config>::report_cdata(const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (traits_t::on_cdata::value)
+            xpar_detail::call_if(typename traits_t::on_cdata {}, *observer_,
+                                 [&](auto& observer) { observer.on_cdata(*this, text, text_end, partial); });
+        else
+            xpar_detail::call_if(typename traits_t::on_data {}, *observer_,
+                                 [&](auto& observer) { observer.on_data(*this, text, text_end, partial); });
+    }
+
+    template <typename _Observer, typename _Config>
+    typename xpar_dfa<_Observer, _Config>::uint_t xpar_dfa<_Observer, _Config>::column() const noexcept
+    {
+        const char_t* line_begin = ptr_;
+        while ((line_begin != begin_) && (line_begin[-1] != '\n'))
+            --line_begin;
+        return static_cast<uint_t>(1U + ptr_ - line_begin + ((line_begin != begin_) ? 0U : column_base_));
+    }
+
+    template <typename _Observer, typename _Config>
+    const typename xpar_dfa<_Observer, _Config>::char_t* xpar_dfa<_Observer, _Config>::stack_value(const uint_t index) const noexcept
+    {
+        const auto offset = config_t::max_name_length * index;
+        return offset < stack_buffer_.size() ? stack_buffer_.data() + offset : nullptr;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_dfa<_Observer, _Config>::reset() noexcept
+    {
+        ptr_ = {};
+        begin_ = {};
+        end_ = {};
+        mark_ = {};
+        base_offset_ = {};
+        carry_size_ = {};
+        line_ = 1U;
+        column_base_ = {};
+        depth_ = {};
+        pending_ = {};
+        matched_ = {};
+        state_ = xpar_detail::s_content;
+        error_ = {};
+        carried_ = {};
+    }
+}
@@ -0,0 +1,379 @@
+/// xpar_dom - Compact document tree built from xpar events
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <memory>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /// Bump pointer allocator for text; the memory is released all at once by clear.
+    template <typename _Char>
+    class xpar_arena
+    {
+    public:
+        xpar_arena(const std::size_t block_size = 16384U) noexcept: block_size_(block_size) {}
+
+        _Char* allocate(const std::size_t size);
+
+        /// Appends to the last allocation, in place when it ends at the top of the current block; returns where it is now.
+        _Char* append(const _Char* last, const std::size_t last_size, const _Char* text, const _Char* text_end);
+
+        /// The next block holds at least size characters.
+        void reserve(const std::size_t size) noexcept { reserved_ = std::max(reserved_, size); }
+
+        void clear() noexcept;
+
+    protected:
+        std::vector<std::unique_ptr<_Char[]>> blocks_ {};
+        _Char* top_ {};
+        _Char* end_ {};
+        std::size_t block_size_;
+        std::size_t reserved_ {};
+    };
+
+    template <typename _Char>
+    _Char* xpar_arena<_Char>::allocate(const std::size_t size)
+    {
+        if (static_cast<std::size_t>(end_ - top_) < size)
+        {
+            const std::size_t block_size = std::max(std::max(block_size_, reserved_), size);
+            blocks_.emplace_back(new _Char[block_size]);
+            top_ = blocks_.back().get();
+            end_ = top_ + block_size;
+            reserved_ = 0U;
+        }
+
+        _Char* const result = top_;
+        top_ += size;
+        return result;
+    }
+
+    template <typename _Char>
+    _Char* xpar_arena<_Char>::append(const _Char* last, const std::size_t last_size, const _Char* text, const _Char* text_end)
+    {
+        const std::size_t size = text_end - text;
+        if ((last + last_size == top_) && (static_cast<std::size_t>(end_ - top_) >= size))
+        {
+            std::copy(text, text_end, top_);
+            top_ += size;
+            return const_cast<_Char*>(last);
+        }
+
+        _Char* const result = allocate(last_size + size);
+        std::copy(text, text_end, std::copy(last, last + last_size, result));
+        return result;
+    }
+
+    template <typename _Char>
+    void xpar_arena<_Char>::clear() noexcept
+    {
+        blocks_.clear();
+        top_ = end_ = nullptr;
+    }
+
+    template <typename _Config>
+    class xpar_dom_builder;
+
+    /// Document tree stored as structure of arrays, node 0 being the document. The attributes of an element are its first children,
+    /// followed by the content nodes. Names and values are (pointer, size) spans into the source when it is kept, see
+    /// xpar_dom_builder::build, otherwise into the arena.
+    template <typename _Config = xpar_default_config>
+    class xpar_dom
+    {
+    public:
+        using char_t = typename _Config::char_t;
+        using node_t = std::uint32_t;
+
+        enum kind_t : std::uint8_t
+        {
+            document,
+            element,
+            attribute,
+            text,
+            cdata,
+            comment,
+        };
+
+        enum constant : node_t
+        {
+            no_node = 0xFFFFFFFFU,
+        };
+
+        xpar_dom() { clear(); }
+
+        std::size_t size() const noexcept { return kind_.size(); }
+        node_t root() const noexcept;
+
+        kind_t kind(const node_t node) const noexcept { return static_cast<kind_t>(kind_[node]); }
+        node_t parent(const node_t node) const noexcept { return parent_[node]; }
+        node_t first_child(const node_t node) const noexcept { return first_child_[node]; }
+        node_t next_sibling(const node_t node) const noexcept { return next_sibling_[node]; }
+
+        const char_t* name(const node_t node) const noexcept { return name_[node]; }
+        const char_t* name_end(const node_t node) const noexcept { return name_[node] + name_size_[node]; }
+        const char_t* value(const node_t node) const noexcept { return value_[node]; }
+        const char_t* value_end(const node_t node) const noexcept { return value_[node] + value_size_[node]; }
+
+        /// Pre-scan of a whole document sizing the node arrays and the arena to upper bounds, so that building it never reallocates.
+        void reserve(const char_t* source, const std::size_t size);
+
+        void clear();
+
+    protected:
+        friend class xpar_dom_builder<_Config>;
+
+        node_t add(const kind_t kind, const node_t parent);
+
+        std::vector<node_t> parent_ {};
+        std::vector<node_t> first_child_ {};
+        std::vector<node_t> next_sibling_ {};
+        std::vector<std::uint8_t> kind_ {};
+        std::vector<const char_t*> name_ {};
+        std::vector<std::uint32_t> name_size_ {};
+        std::vector<const char_t*> value_ {};
+        std::vector<std::uint32_t> value_size_ {};
+        xpar_arena<char_t> arena_ {};
+    };
+
+    template <typename _Config>
+    typename xpar_dom<_Config>::node_t xpar_dom<_Config>::root() const noexcept
+    {
+        node_t node = first_child_[0U];
+        while ((node != no_node) && (kind_[node] != element))
+            node = next_sibling_[node];
+
+        return node;
+    }
+
+    template <typename _Config>
+    void xpar_dom<_Config>::reserve(const char_t* source, const std::size_t size)
+    {
+        // every '<' opens at most one element and closes at most one text, every attribute has a '='
+        const std::size_t tags = xpar_detail::count(source, source + size, char_t('<'));
+        const std::size_t nodes = std::size_t(2U) * tags + xpar_detail::count(source, source + size, char_t('=')) + 2U;
+        parent_.reserve(nodes);
+        first_child_.reserve(nodes);
+        next_sibling_.reserve(nodes);
+        kind_.reserve(nodes);
+        name_.reserve(nodes);
+        name_size_.reserve(nodes);
+        value_.reserve(nodes);
+        value_size_.reserve(nodes);
+
+        // an upper bound: only the text split or decoded by the parser is copied, which is at most the source
+        arena_.reserve(size);
+    }
+
+    template <typename _Config>
+    void xpar_dom<_Config>::clear()
+    {
+        parent_.clear();
+        first_child_.clear();
+        next_sibling_.clear();
+        kind_.clear();
+        name_.clear();
+        name_size_.clear();
+        value_.clear();
+        value_size_.clear();
+        arena_.clear();
+        add(document, no_node);
+    }
+
+    template <typename _Config>
+    typename xpar_dom<_Config>::node_t xpar_dom<_Config>::add(const kind_t kind, const node_t parent)
+    {
+        const node_t node = static_cast<node_t>(kind_.size());
+        parent_.push_back(parent);
+        first_child_.push_back(no_node);
+        next_sibling_.push_back(no_node);
+        kind_.push_back(kind);
+        name_.push_back(nullptr);
+        name_size_.push_back(0U);
+        value_.push_back(nullptr);
+        value_size_.push_back(0U);
+        return node;
+    }
+
+    /// Observer building an xpar_dom, about a memory write per node field. With build() the source is kept and the names and
+    /// the values read in one piece refer to it; with operator() the buffers may be reused and everything is copied to the arena.
+    template <typename _Config = xpar_default_config>
+    class xpar_dom_builder
+    {
+    public:
+        using xpar_t = xpar<xpar_dom_builder, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using dom_t = xpar_dom<_Config>;
+        using node_t = typename dom_t::node_t;
+
+        static_assert(!xpar_options<_Config>::lazy_attributes, "xpar_dom_builder reads the attributes one by one");
+
+        xpar_dom_builder(dom_t* const dom): dom_(dom) { reset(); }
+
+        /// Parses a whole document the dom may refer to, the source must outlive it.
+        void build(const char_t* source, const std::size_t size);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { parser_(buffer, buffer_size); }
+
+        xpar_t& parser() noexcept { return parser_; }
+        dom_t* dom() const noexcept { return dom_; }
+
+        /// Restarts the parsing, the dom is not cleared.
+        void reset();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            add_text(dom_t::text, text, text_end, partial);
+        }
+
+        void on_cdata(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            add_text(dom_t::cdata, text, text_end, partial);
+        }
+
+        void on_comment(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            add_text(dom_t::comment, text, text_end, partial);
+        }
+
+    protected:
+        node_t add(const typename dom_t::kind_t kind);
+        const char_t* read(const char_t* text, const char_t* text_end) const noexcept;
+        void set(std::vector<const char_t*>& texts, std::vector<std::uint32_t>& sizes, const node_t node, const char_t* text,
+                 const char_t* text_end, const char_t* source);
+        void add_text(const typename dom_t::kind_t kind, const char_t* text, const char_t* text_end, const bool partial);
+
+        xpar_t parser_ {this};
+        dom_t* dom_;
+        std::vector<node_t> open_ {};       // the open elements, the document first
+        std::vector<node_t> last_child_ {}; // of each open element
+        node_t text_ {dom_t::no_node};      // text node the next piece of the same kind goes to
+        const char_t* source_ {};
+        const char_t* source_end_ {};
+        std::uint64_t source_offset_ {};
+    };
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::reset()
+    {
+        parser_.reset();
+        open_.assign(1U, 0U);
+        last_child_.assign(1U, dom_->first_child_[0U]);
+        while ((last_child_[0U] != dom_t::no_node) && (dom_->next_sibling_[last_child_[0U]] != dom_t::no_node))
+            last_child_[0U] = dom_->next_sibling_[last_child_[0U]];
+        text_ = dom_t::no_node;
+        source_ = source_end_ = nullptr;
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::build(const char_t* source, const std::size_t size)
+    {
+        source_ = source;
+        source_end_ = source + size;
+        source_offset_ = parser_.offset();
+        parser_(source, size);
+        source_ = source_end_ = nullptr;
+    }
+
+    template <typename _Config>
+    typename xpar_dom_builder<_Config>::node_t xpar_dom_builder<_Config>::add(const typename dom_t::kind_t kind)
+    {
+        const node_t node = dom_->add(kind, open_.back());
+        node_t& last = last_child_.back();
+        (last == dom_t::no_node ? dom_->first_child_[open_.back()] : dom_->next_sibling_[last]) = node;
+        last = node;
+        text_ = dom_t::no_node;
+        return node;
+    }
+
+    template <typename _Config>
+    const typename xpar_dom_builder<_Config>::char_t* xpar_dom_builder<_Config>::read(const char_t* text,
+                                                                                        const char_t* text_end) const noexcept
+    {
+        // names and attribute values are copied by the parser, the source has them just before the current position
+        if (!source_)
+            return nullptr;
+
+        const std::size_t position = static_cast<std::size_t>(parser_.offset() - source_offset_);
+        const std::size_t size = text_end - text;
+        return (position >= size) && (position <= static_cast<std::size_t>(source_end_ - source_)) ? source_ + position - size : nullptr;
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::set(std::vector<const char_t*>& texts, std::vector<std::uint32_t>& sizes, const node_t node,
+                                        const char_t* text, const char_t* text_end, const char_t* source)
+    {
+        if (source && (sizes[node] == 0U))
+            texts[node] = source;
+        else
+            texts[node] = dom_->arena_.append(texts[node], sizes[node], text, text_end);
+        sizes[node] += static_cast<std::uint32_t>(text_end - text);
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::on_element_begin(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        const node_t node = add(dom_t::element);
+        set(dom_->name_, dom_->name_size_, node, name, name_end, read(name, name_end));
+        open_.push_back(node);
+        last_child_.push_back(dom_t::no_node);
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/)
+    {
+        text_ = dom_t::no_node;
+        if (open_.size() > 1U)
+        {
+            open_.pop_back();
+            last_child_.pop_back();
+        }
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        const node_t node = add(dom_t::attribute);
+        set(dom_->name_, dom_->name_size_, node, name, name_end, read(name, name_end));
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end,
+                                                       const bool /*partial*/)
+    {
+        const node_t node = last_child_.back();
+        if ((node == dom_t::no_node) || (dom_->kind_[node] != dom_t::attribute))
+            return;
+
+        const char_t* const source = xpar_options<_Config>::decode_references ? nullptr : read(text, text_end);
+        set(dom_->value_, dom_->value_size_, node, text, text_end, source);
+    }
+
+    template <typename _Config>
+    void xpar_dom_builder<_Config>::add_text(const typename dom_t::kind_t kind, const char_t* text, const char_t* text_end,
+                                             const bool partial)
+    {
+        // a text split by the buffers or the decoding comes in pieces, the ones after the first are appended in the arena
+        node_t node = text_;
+        if ((node == dom_t::no_node) || (dom_->kind_[node] != kind))
+        {
+            if (text == text_end)
+                return;
+
+            node = add(kind);
+        }
+
+        const bool in_source = !partial && source_ && (text >= source_) && (text_end <= source_end_);
+        set(dom_->value_, dom_->value_size_, node, text, text_end, in_source ? text : nullptr);
+        text_ = partial ? node : dom_t::no_node;
+    }
+}
@@ -0,0 +1,341 @@
+/// xpar_dom_index - Posting list index and XPath subset queries over an xpar_dom
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar_dom.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /// Index of a document for repeated queries: per name posting lists of the elements and the attributes, the elements having
+    /// an attribute or an attribute value, and the subtree of every node as the range [node, end(node)) of the node numbers, which
+    /// follow the document order. It refers to the dom, built from one xpar pass, and is built from it in linear time.
+    ///
+    /// Queries are absolute location paths of the XPath subset "/a/b", "//b", "/a/*//c", a final "@name" or "@*" step, and the
+    /// predicates [@name], [@name='value'] and [position], applied in order. A step is evaluated by merging the posting list of
+    /// its name with the ranges of the context nodes; a predicate intersects with another posting list or counts per parent.
+    template <typename _Config = xpar_default_config>
+    class xpar_dom_index
+    {
+    public:
+        using dom_t = xpar_dom<_Config>;
+        using char_t = typename dom_t::char_t;
+        using node_t = typename dom_t::node_t;
+        using string_t = std::basic_string<char_t>;
+        using nodes_t = std::vector<node_t>;
+
+        class query_t
+        {
+        private:
+            friend class xpar_dom_index;
+
+            struct predicate_t
+            {
+                const nodes_t* owners; // elements having the attribute or the value, null for a position or nothing found
+                std::uint32_t position;
+            };
+
+            struct step_t
+            {
+                const nodes_t* nodes; // null if no node has the name
+                std::vector<predicate_t> predicates;
+                bool descendant;
+            };
+
+            std::vector<step_t> steps_ {};
+        };
+
+        xpar_dom_index() = default;
+        xpar_dom_index(const dom_t& dom) { build(dom); }
+
+        /// Indexes a complete document; the dom must not change while the index is used.
+        void build(const dom_t& dom);
+
+        /// Reads a query once for many selections, returns false for a syntax outside the subset. The query stays valid until
+        /// the index is built again.
+        bool compile(const char_t* query, const char_t* query_end, query_t& result) const;
+
+        /// The nodes a query selects below the context, the document by default, in document order.
+        void select(const query_t& query, nodes_t& result) const { select(query, 0U, result); }
+        void select(const query_t& query, const node_t context, nodes_t& result) const;
+        bool select(const char_t* query, const char_t* query_end, nodes_t& result) const;
+
+        const dom_t* dom() const noexcept { return dom_; }
+        node_t end(const node_t node) const noexcept { return end_[node]; }
+        bool contains(const node_t ancestor, const node_t node) const noexcept { return (ancestor < node) && (node < end_[ancestor]); }
+
+        /// The elements with the name, in document order.
+        const nodes_t& elements(const char_t* name, const char_t* name_end) const;
+
+    protected:
+        static void intersect(nodes_t& nodes, const nodes_t& owners);
+        static void key(string_t& result, const char_t* name, const char_t* name_end, const char_t* value, const char_t* value_end);
+        void merge(const nodes_t& nodes, const nodes_t& context, const bool descendant, nodes_t& result) const;
+        void keep_position(nodes_t& nodes, const std::uint32_t position) const;
+        const nodes_t* find(const std::unordered_map<string_t, nodes_t>& lists, const string_t& name) const;
+
+        const dom_t* dom_ {};
+        nodes_t end_ {};
+        nodes_t all_elements_ {};
+        nodes_t all_attributes_ {};
+        std::unordered_map<string_t, nodes_t> elements_ {};
+        std::unordered_map<string_t, nodes_t> attributes_ {};
+        std::unordered_map<string_t, nodes_t> owners_ {}; // elements by attribute name
+        std::unordered_map<string_t, nodes_t> values_ {}; // elements by attribute name, '\0', value
+        nodes_t empty_ {};
+    };
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::key(string_t& result, const char_t* name, const char_t* name_end, const char_t* value,
+                                      const char_t* value_end)
+    {
+        result.assign(name, name_end);
+        result += char_t();
+        result.append(value, value_end);
+    }
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::build(const dom_t& dom)
+    {
+        dom_ = &dom;
+        const node_t size = static_cast<node_t>(dom.size());
+        end_.resize(size);
+        for (node_t node = 0U; node != size; ++node)
+            end_[node] = node + 1U;
+        for (node_t node = size; node-- > 1U;)
+            end_[dom.parent(node)] = std::max(end_[dom.parent(node)], end_[node]);
+
+        all_elements_.clear();
+        all_attributes_.clear();
+        elements_.clear();
+        attributes_.clear();
+        owners_.clear();
+        values_.clear();
+        string_t name;
+        string_t value_key;
+        for (node_t node = 0U; node != size; ++node)
+        {
+            const auto kind = dom.kind(node);
+            if (kind == dom_t::element)
+            {
+                all_elements_.push_back(node);
+                elements_[name.assign(dom.name(node), dom.name_end(node))].push_back(node);
+            }
+            else if (kind == dom_t::attribute)
+            {
+                const node_t owner = dom.parent(node);
+                all_attributes_.push_back(node);
+                attributes_[name.assign(dom.name(node), dom.name_end(node))].push_back(node);
+
+                // a repeated attribute name, not well-formed, is listed once
+                nodes_t& owners = owners_[name];
+                if (owners.empty() || (owners.back() != owner))
+                    owners.push_back(owner);
+
+                key(value_key, dom.name(node), dom.name_end(node), dom.value(node), dom.value_end(node));
+                nodes_t& values = values_[value_key];
+                if (values.empty() || (values.back() != owner))
+                    values.push_back(owner);
+            }
+        }
+    }
+
+    template <typename _Config>
+    const typename xpar_dom_index<_Config>::nodes_t* xpar_dom_index<_Config>::find(const std::unordered_map<string_t, nodes_t>& lists,
+                                                                                   const string_t& name) const
+    {
+        const auto found = lists.find(name);
+        return (found != lists.end()) ? &found->second : nullptr;
+    }
+
+    template <typename _Config>
+    const typename xpar_dom_index<_Config>::nodes_t& xpar_dom_index<_Config>::elements(const char_t* name, const char_t* name_end) const
+    {
+        const nodes_t* const nodes = find(elements_, string_t(name, name_end));
+        return nodes ? *nodes : empty_;
+    }
+
+    template <typename _Config>
+    bool xpar_dom_index<_Config>::compile(const char_t* query, const char_t* query_end, query_t& result) const
+    {
+        const auto is_name_end = [](const char_t c) { return (c == '/') || (c == '[') || (c == ']') || (c == '=') || (c == '@'); };
+        auto& steps = result.steps_;
+        steps.clear();
+        string_t name;
+        string_t value_key;
+        while (query != query_end)
+        {
+            if (*query != '/')
+                return false;
+
+            typename query_t::step_t step {};
+            step.descendant = (query_end - query > 1) && (query[1] == '/');
+            query += step.descendant ? 2 : 1;
+            const bool attribute = (query != query_end) && (*query == '@');
+            query += attribute ? 1 : 0;
+            const char_t* const name_begin = query;
+            query = std::find_if(query, query_end, is_name_end);
+            if ((name_begin == query) || (attribute && (query != query_end)))
+                return false;
+
+            name.assign(name_begin, query);
+            const bool any = name.size() == 1U && name[0] == '*';
+            if (attribute)
+                step.nodes = any ? &all_attributes_ : find(attributes_, name);
+            else
+                step.nodes = any ? &all_elements_ : find(elements_, name);
+
+            while ((query != query_end) && (*query == '['))
+            {
+                typename query_t::predicate_t predicate {};
+                const char_t* const predicate_end = std::find(++query, query_end, char_t(']'));
+                if (predicate_end == query_end)
+                    return false;
+
+                if (*query == '@')
+                {
+                    const char_t* const attribute_name = ++query;
+                    query = std::find_if(query, predicate_end, is_name_end);
+                    if (attribute_name == query)
+                        return false;
+
+                    if (query == predicate_end)
+                        predicate.owners = find(owners_, name.assign(attribute_name, query));
+                    else
+                    {
+                        // ='value' or ="value"
+                        const char_t quote = (predicate_end - query >= 3) && (*query == '=') ? query[1] : char_t();
+                        if (((quote != '\'') && (quote != '"')) || (predicate_end[-1] != quote))
+                            return false;
+
+                        key(value_key, attribute_name, query, query + 2, predicate_end - 1);
+                        predicate.owners = find(values_, value_key);
+                    }
+                }
+                else
+                {
+                    for (; query != predicate_end; ++query)
+                    {
+                        if ((*query < '0') || (*query > '9') || (predicate.position > 0x0FFFFFFFU))
+                            return false;
+                        predicate.position = predicate.position * 10U + static_cast<std::uint32_t>(*query - '0');
+                    }
+
+                    if (predicate.position == 0U)
+                        return false;
+                }
+
+                step.predicates.push_back(predicate);
+                query = predicate_end + 1;
+            }
+
+            steps.push_back(std::move(step));
+        }
+
+        return !steps.empty();
+    }
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::merge(const nodes_t& nodes, const nodes_t& context, const bool descendant, nodes_t& result) const
+    {
+        // the context ranges are nested or disjoint; the ones holding the current node form a stack, the deepest on top
+        result.clear();
+        nodes_t open;
+        auto node = nodes.begin();
+        auto next = context.begin();
+        while (node != nodes.end())
+        {
+            for (; (next != context.end()) && (*next < *node); ++next)
+            {
+                while (!open.empty() && (end_[open.back()] <= *next))
+                    open.pop_back();
+                open.push_back(*next);
+            }
+
+            while (!open.empty() && (end_[open.back()] <= *node))
+                open.pop_back();
+
+            if (open.empty())
+            {
+                // nothing to match before the next context node
+                if (next == context.end())
+                    break;
+                node = std::upper_bound(node, nodes.end(), *next);
+                continue;
+            }
+
+            if (descendant || (dom_->parent(*node) == open.back()))
+                result.push_back(*node);
+            ++node;
+        }
+    }
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::intersect(nodes_t& nodes, const nodes_t& owners)
+    {
+        auto owner = owners.begin();
+        const auto kept = std::remove_if(nodes.begin(), nodes.end(), [&](const node_t node)
+                                         {
+                                             owner = std::lower_bound(owner, owners.end(), node);
+                                             return (owner == owners.end()) || (*owner != node);
+                                         });
+        nodes.erase(kept, nodes.end());
+    }
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::keep_position(nodes_t& nodes, const std::uint32_t position) const
+    {
+        // the position among the selected children of the same parent
+        std::unordered_map<node_t, std::uint32_t> counts;
+        const auto kept = std::remove_if(nodes.begin(), nodes.end(),
+                                         [&](const node_t node) { return ++counts[dom_->parent(node)] != position; });
+        nodes.erase(kept, nodes.end());
+    }
+
+    template <typename _Config>
+    void xpar_dom_index<_Config>::select(const query_t& query, const node_t context, nodes_t& result) const
+    {
+        result.assign(1U, context);
+        nodes_t next;
+        for (const auto& step: query.steps_)
+        {
+            if (!step.nodes)
+            {
+                result.clear();
+                return;
+            }
+
+            merge(*step.nodes, result, step.descendant, next);
+            for (const auto& predicate: step.predicates)
+            {
+                if (predicate.position != 0U)
+                    keep_position(next, predicate.position);
+                else if (predicate.owners)
+                    intersect(next, *predicate.owners);
+                else
+                    next.clear();
+            }
+
+            result.swap(next);
+            if (result.empty())
+                return;
+        }
+    }
+
+    template <typename _Config>
+    bool xpar_dom_index<_Config>::select(const char_t* query, const char_t* query_end, nodes_t& result) const
+    {
+        query_t compiled;
+        if (!compile(query, query_end, compiled))
+            return false;
+
+        select(compiled, result);
+        return true;
+    }
+}
@@ -0,0 +1,476 @@
+/// xpar_encoding - Encoding detection and UTF-8 transcoding in front of xpar
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include <algorithm>
+    #include <array>
+    #include <cstdint>
+    #include <cstring>
+    #include <vector>
+    #if defined(__SSE2__)
+        #include <emmintrin.h>
+    #endif
+#endif
+
+namespace stdext
+{
+    enum class xpar_encoding
+    {
+        unknown,
+        utf8,
+        utf16le,
+        utf16be,
+        latin1,
+    };
+
+    namespace xpar_detail
+    {
+        inline bool equal_no_case(const char* begin, const char* end, const char* name) noexcept
+        {
+            for (; (begin != end) && (*name != '\0'); ++begin, ++name)
+                if (((*begin >= 'A') && (*begin <= 'Z') ? *begin - 'A' + 'a' : *begin) != *name)
+                    return false;
+
+            return (begin == end) && (*name == '\0');
+        }
+
+        /// Encoding named by the encoding="..." pseudo-attribute of an XML declaration, utf8 when missing or not supported.
+        inline xpar_encoding declared_encoding(const char* begin, const char* end) noexcept
+        {
+            static const char attribute[] = "encoding";
+            const char* found = std::search(begin, end, attribute, attribute + sizeof(attribute) - 1U);
+            if (found == end)
+                return xpar_encoding::utf8;
+
+            found += sizeof(attribute) - 1U;
+            while ((found != end) && ((*found == ' ') || (*found == '=') || (*found == '\t') || (*found == '\r') || (*found == '\n')))
+                ++found;
+            if ((found == end) || ((*found != '"') && (*found != '\'')))
+                return xpar_encoding::utf8;
+
+            const char* const name = found + 1;
+            const char* const name_end = std::find(name, end, *found);
+            for (const char* latin1: {"iso-8859-1", "iso_8859-1", "latin1", "latin-1", "l1", "iso-ir-100", "cp819"})
+                if (equal_no_case(name, name_end, latin1))
+                    return xpar_encoding::latin1;
+
+            return xpar_encoding::utf8;
+        }
+    }
+
+    /// Streaming front-end feeding a char parser with UTF-8: the encoding is taken from the BOM, the first bytes or the XML declaration,
+    /// UTF-16 and Latin-1 input is transcoded in blocks, UTF-8 input is forwarded as it is and optionally validated.
+    /// Unpaired surrogates become U+FFFD. When validating, a UTF-8 character split by the chunk end is held until it is complete
+    /// and the bytes before the first invalid sequence are forwarded, then the forwarding stops and failed() is set.
+    template <typename _Parser>
+    class xpar_transcoder
+    {
+    public:
+        using parser_t = _Parser;
+
+        xpar_transcoder(parser_t* const parser, const bool validate = false, const xpar_encoding encoding = xpar_encoding::unknown):
+            parser_(parser), forced_(encoding), encoding_(encoding), validate_(validate)
+        {
+        }
+
+        void operator()(const void* const data, const std::size_t size);
+        /// Parses the bytes held for detection and checks the input did not end inside a character.
+        void finish();
+
+        xpar_encoding encoding() const noexcept { return encoding_; }
+        bool failed() const noexcept { return failed_; }
+        parser_t* parser() const noexcept { return parser_; }
+
+        void reset() noexcept;
+
+    protected:
+        enum constant
+        {
+            block_size = 16384,
+            max_head_size = 256
+        };
+
+        using head_t = std::array<unsigned char, max_head_size>;
+        using utf8_pending_t = std::array<char, 4U>;
+        using output_t = std::vector<char>;
+
+        void detect(const bool final);
+        void convert(const unsigned char* in, const unsigned char* end);
+        void forward_utf8(const unsigned char* in, const unsigned char* end);
+        const unsigned char* validate(const unsigned char* in, const unsigned char* end) noexcept;
+        char* latin1(const unsigned char* in, const unsigned char* end, char* out) noexcept;
+        char* utf16(const unsigned char* in, const unsigned char* end, char* out) noexcept;
+        char* put(const std::uint16_t unit, char* out) noexcept;
+
+        head_t head_ {};
+        output_t output_ {};
+        parser_t* parser_;
+        std::size_t head_size_ {};
+        xpar_encoding forced_;
+        xpar_encoding encoding_;
+        utf8_pending_t utf8_pending_ {};
+        std::uint16_t high_surrogate_ {};
+        std::uint8_t odd_byte_ {};
+        std::uint8_t utf8_remaining_ {};
+        std::uint8_t utf8_min_ {};
+        std::uint8_t utf8_max_ {};
+        std::uint8_t utf8_pending_size_ {};
+        bool odd_ {};
+        bool validate_;
+        bool failed_ {};
+    };
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::operator()(const void* const data, const std::size_t size)
+    {
+        auto in = static_cast<const unsigned char*>(data);
+        if (encoding_ == xpar_encoding::unknown)
+        {
+            const std::size_t count = std::min<std::size_t>(size, head_.size() - head_size_);
+            std::memcpy(head_.data() + head_size_, in, count);
+            head_size_ += count;
+            detect(false);
+            if (encoding_ == xpar_encoding::unknown)
+                return;
+
+            in += count;
+        }
+
+        convert(in, static_cast<const unsigned char*>(data) + size);
+    }
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::finish()
+    {
+        if (encoding_ == xpar_encoding::unknown)
+            detect(true);
+
+        // an unpaired high surrogate and a lone byte each become U+FFFD
+        char replacement[6];
+        char* out = replacement;
+        if (high_surrogate_ != 0U)
+        {
+            high_surrogate_ = 0U;
+            out = put(0xFFFDU, out);
+        }
+
+        if (odd_)
+        {
+            odd_ = false;
+            out = put(0xFFFDU, out);
+        }
+
+        if (out != replacement)
+            parser_->operator()(replacement, out - replacement);
+
+        if (utf8_remaining_ != 0U)
+            failed_ = true;
+    }
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::reset() noexcept
+    {
+        head_size_ = {};
+        encoding_ = forced_;
+        high_surrogate_ = {};
+        odd_byte_ = {};
+        utf8_remaining_ = {};
+        utf8_pending_size_ = {};
+        odd_ = {};
+        failed_ = {};
+    }
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::detect(const bool final)
+    {
+        const unsigned char* const head = head_.data();
+        const std::size_t size = head_size_;
+        std::size_t bom = 0U;
+        if ((size >= 3U) && (head[0] == 0xEFU) && (head[1] == 0xBBU) && (head[2] == 0xBFU))
+        {
+            encoding_ = xpar_encoding::utf8;
+            bom = 3U;
+        }
+        else if ((size >= 2U) && (head[0] == 0xFFU) && (head[1] == 0xFEU))
+        {
+            encoding_ = xpar_encoding::utf16le;
+            bom = 2U;
+        }
+        else if ((size >= 2U) && (head[0] == 0xFEU) && (head[1] == 0xFFU))
+        {
+            encoding_ = xpar_encoding::utf16be;
+            bom = 2U;
+        }
+        else if ((size < 4U) && !final)
+            return;
+        else if ((size >= 2U) && (head[0] != 0U) && (head[1] == 0U))
+            encoding_ = xpar_encoding::utf16le; // a document starts with an ASCII character, '<' or a space
+        else if ((size >= 2U) && (head[0] == 0U) && (head[1] != 0U))
+            encoding_ = xpar_encoding::utf16be;
+        else if ((size >= 5U) && (std::memcmp(head, "<?xml", 5U) == 0))
+        {
+            // the declaration is ASCII, wait for its end
+            const char* const text = reinterpret_cast<const char*>(head);
+            static const char declaration_end[] = "?>";
+            const char* const end = std::search(text, text + size, declaration_end, declaration_end + 2);
+            if ((end == text + size) && (size != head_.size()) && !final)
+                return;
+
+            encoding_ = xpar_detail::declared_encoding(text, end);
+        }
+        else if (!final && (size < 5U) && (std::memcmp(head, "<?xml", size) == 0))
+            return;
+        else
+            encoding_ = xpar_encoding::utf8;
+
+        head_size_ = 0U;
+        convert(head + bom, head + size);
+    }
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::convert(const unsigned char* in, const unsigned char* end)
+    {
+        if (failed_ || (in == end))
+            return;
+
+        if (encoding_ == xpar_encoding::utf8)
+        {
+            if (validate_)
+                forward_utf8(in, end);
+            else
+                parser_->operator()(reinterpret_cast<const char*>(in), end - in);
+            return;
+        }
+
+        // UTF-16 takes at most 3 bytes per 2, Latin-1 2 per 1
+        output_.resize(2U * block_size + 16U);
+        for (; in != end;)
+        {
+            const unsigned char* const block_end = in + std::min<std::size_t>(end - in, block_size);
+            char* const out = output_.data();
+            char* const out_end = (encoding_ == xpar_encoding::latin1) ? latin1(in, block_end, out) : utf16(in, block_end, out);
+            if (out_end != out)
+                parser_->operator()(out, out_end - out);
+            in = block_end;
+        }
+    }
+
+    template <typename _Parser>
+    char* xpar_transcoder<_Parser>::latin1(const unsigned char* in, const unsigned char* end, char* out) noexcept
+    {
+        while (in != end)
+        {
+#if defined(__SSE2__)
+            for (; end - in >= 16; in += 16, out += 16)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                if (_mm_movemask_epi8(block) != 0)
+                    break;
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+            }
+
+            if (in == end)
+                break;
+#endif
+            const unsigned char value = *in++;
+            if (value < 0x80U)
+                *out++ = static_cast<char>(value);
+            else
+            {
+                *out++ = static_cast<char>(0xC0U | (value >> 6));
+                *out++ = static_cast<char>(0x80U | (value & 0x3FU));
+            }
+        }
+
+        return out;
+    }
+
+    template <typename _Parser>
+    char* xpar_transcoder<_Parser>::utf16(const unsigned char* in, const unsigned char* end, char* out) noexcept
+    {
+        const bool big_endian = encoding_ == xpar_encoding::utf16be;
+        if (odd_)
+        {
+            odd_ = false;
+            const unsigned char value = *in++;
+            out = put(static_cast<std::uint16_t>(big_endian ? (odd_byte_ << 8) | value : (value << 8) | odd_byte_), out);
+        }
+
+        while (end - in >= 2)
+        {
+#if defined(__SSE2__)
+            // 8 ASCII units at a time: test the high 9 bits of each unit and narrow them with a saturating pack
+            const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80U));
+            for (; (end - in >= 16) && (high_surrogate_ == 0U); in += 16, out += 8)
+            {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                if (big_endian)
+                    block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, mask), _mm_setzero_si128())) != 0xFFFF)
+                    break;
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(block, block));
+            }
+
+            if (end - in < 2)
+                break;
+#endif
+            const auto unit = static_cast<std::uint16_t>(big_endian ? (in[0] << 8) | in[1] : (in[1] << 8) | in[0]);
+            in += 2;
+            out = put(unit, out);
+        }
+
+        if (in != end)
+        {
+            odd_ = true;
+            odd_byte_ = *in;
+        }
+
+        return out;
+    }
+
+    template <typename _Parser>
+    char* xpar_transcoder<_Parser>::put(const std::uint16_t unit, char* out) noexcept
+    {
+        std::uint32_t code = unit;
+        if (high_surrogate_ != 0U)
+        {
+            if ((unit >= 0xDC00U) && (unit <= 0xDFFFU))
+            {
+                code = 0x10000U + ((high_surrogate_ - 0xD800U) << 10) + (unit - 0xDC00U);
+                high_surrogate_ = 0U;
+                *out++ = static_cast<char>(0xF0U | (code >> 18));
+                *out++ = static_cast<char>(0x80U | ((code >> 12) & 0x3FU));
+                *out++ = static_cast<char>(0x80U | ((code >> 6) & 0x3FU));
+                *out++ = static_cast<char>(0x80U | (code & 0x3FU));
+                return out;
+            }
+
+            high_surrogate_ = 0U;
+            out = put(0xFFFDU, out);
+        }
+
+        if ((unit >= 0xD800U) && (unit <= 0xDBFFU))
+        {
+            high_surrogate_ = unit;
+            return out;
+        }
+
+        if ((unit >= 0xDC00U) && (unit <= 0xDFFFU))
+            code = 0xFFFDU;
+
+        if (code < 0x80U)
+            *out++ = static_cast<char>(code);
+        else if (code < 0x800U)
+        {
+            *out++ = static_cast<char>(0xC0U | (code >> 6));
+            *out++ = static_cast<char>(0x80U | (code & 0x3FU));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xE0U | (code >> 12));
+            *out++ = static_cast<char>(0x80U | ((code >> 6) & 0x3FU));
+            *out++ = static_cast<char>(0x80U | (code & 0x3FU));
+        }
+
+        return out;
+    }
+
+    template <typename _Parser>
+    void xpar_transcoder<_Parser>::forward_utf8(const unsigned char* in, const unsigned char* end)
+    {
+        if (utf8_pending_size_ != 0U)
+        {
+            // the character begun in the previous chunk
+            const unsigned char* const rest = in + std::min<std::size_t>(utf8_remaining_, end - in);
+            validate(in, rest);
+            if (failed_)
+                return;
+
+            std::memcpy(utf8_pending_.data() + utf8_pending_size_, in, rest - in);
+            utf8_pending_size_ += static_cast<std::uint8_t>(rest - in);
+            in = rest;
+            if (utf8_remaining_ != 0U)
+                return;
+
+            parser_->operator()(utf8_pending_.data(), utf8_pending_size_);
+            utf8_pending_size_ = 0U;
+        }
+
+        const unsigned char* const valid = validate(in, end);
+        if (valid != in)
+            parser_->operator()(reinterpret_cast<const char*>(in), valid - in);
+        if (!failed_)
+        {
+            std::memcpy(utf8_pending_.data(), valid, end - valid);
+            utf8_pending_size_ = static_cast<std::uint8_t>(end - valid);
+        }
+    }
+
+    template <typename _Parser>
+    const unsigned char* xpar_transcoder<_Parser>::validate(const unsigned char* in, const unsigned char* end) noexcept
+    {
+        // utf8_remaining_ continuation bytes are expected, the next one within [utf8_min_, utf8_max_]; returns the end of the
+        // complete characters, an invalid sequence sets failed_
+        const unsigned char* valid = in;
+        while (in != end)
+        {
+            if (utf8_remaining_ == 0U)
+            {
+#if defined(__SSE2__)
+                for (; (end - in >= 16) && (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))) == 0); in += 16)
+                    ;
+                if (in == end)
+                    break;
+#endif
+                valid = in;
+                const unsigned char value = *in++;
+                if (value < 0x80U)
+                    continue;
+
+                utf8_min_ = 0x80U;
+                utf8_max_ = 0xBFU;
+                if ((value >= 0xC2U) && (value <= 0xDFU))
+                    utf8_remaining_ = 1U;
+                else if ((value >= 0xE0U) && (value <= 0xEFU))
+                {
+                    utf8_remaining_ = 2U;
+                    if (value == 0xE0U)
+                        utf8_min_ = 0xA0U;
+                    else if (value == 0xEDU)
+                        utf8_max_ = 0x9FU;
+                }
+                else if ((value >= 0xF0U) && (value <= 0xF4U))
+                {
+                    utf8_remaining_ = 3U;
+                    if (value == 0xF0U)
+                        utf8_min_ = 0x90U;
+                    else if (value == 0xF4U)
+                        utf8_max_ = 0x8FU;
+                }
+                else
+                {
+                    failed_ = true;
+                    return valid;
+                }
+            }
+            else
+            {
+                const unsigned char value = *in++;
+                if ((value < utf8_min_) || (value > utf8_max_))
+                {
+                    failed_ = true;
+                    return valid;
+                }
+
+                --utf8_remaining_;
+                utf8_min_ = 0x80U;
+                utf8_max_ = 0xBFU;
+            }
+        }
+
+        return (utf8_remaining_ == 0U) ? end : valid;
+    }
+}
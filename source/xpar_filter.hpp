@@ -0,0 +1,299 @@
+/// xpar_filter - Zero-copy streaming filter on top of xpar
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <array>
+    #include <vector>
+    #if defined(__unix__) || defined(__APPLE__)
+        #include <cerrno>
+        #include <sys/uio.h>
+    #endif
+#endif
+
+namespace stdext
+{
+    /*class filter_observer_example
+    {
+    public:
+        void on_element_begin(filter_t& filter, const char_t* name, const char_t* name_end, xpar_filter_action& action);
+        void on_error(filter_t& filter, bool& try_continue);
+    };
+
+    class sink_example
+    {
+    public:
+        void write(const xpar_slice<char_t>* slices, const std::size_t count);
+    };*/
+
+    enum class xpar_filter_action
+    {
+        keep,
+        drop,
+        replace,
+    };
+
+    template <typename _Char>
+    struct xpar_slice
+    {
+        const _Char* data;
+        std::size_t size;
+    };
+
+    /// Forwards the input to the sink as slices of the caller's buffers, leaving out the elements the observer drops or replaces.
+    /// Slices handed to the sink are valid only during the write call, replacement texts must live until the chunk is processed.
+    template <typename _Observer, typename _Sink, typename _Config = xpar_default_config>
+    class xpar_filter
+    {
+    public:
+        using observer_t = _Observer;
+        using sink_t = _Sink;
+        using config_t = _Config;
+        using xpar_t = xpar<xpar_filter, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using uint_t = typename xpar_t::uint_t;
+        using slice_t = xpar_slice<char_t>;
+
+        class parser_t: public xpar_t
+        {
+        public:
+            using xpar_t::xpar_t;
+
+            bool start_tag_pending() const noexcept
+            {
+                return (this->state_ == xpar_t::state_t::elem_handle) || ((this->state_ == xpar_t::state_t::elem) && !this->item_read_);
+            }
+        };
+
+        xpar_filter(observer_t* const observer, sink_t* const sink) noexcept: observer_(observer), sink_(sink) {}
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size);
+        void finish();
+
+        void set_replacement(const char_t* text, const char_t* text_end) noexcept
+        {
+            replacement_ = text;
+            replacement_end_ = text_end;
+        }
+
+        parser_t& parser() noexcept { return parser_; }
+        observer_t* observer() const noexcept { return observer_; }
+        sink_t* sink() const noexcept { return sink_; }
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { settle(); }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { settle(); }
+        void on_error(xpar_t& /*parser*/, bool& try_continue) { observer_->on_error(*this, try_continue); }
+
+    protected:
+        enum constant
+        {
+            max_slice_count = 64
+        };
+
+        using slice_buffer_t = std::array<slice_t, max_slice_count>;
+        using carry_t = std::vector<char_t>;
+
+        void push(const char_t* begin, const char_t* end);
+        void flush();
+        void settle();
+
+        parser_t parser_ {this};
+        slice_buffer_t slices_ {};
+        carry_t carry_ {};
+        const char_t* from_ {};
+        const char_t* replacement_ {};
+        const char_t* replacement_end_ {};
+        observer_t* observer_;
+        sink_t* sink_;
+        std::size_t slice_count_ {};
+        uint_t drop_depth_ {};
+        bool pending_ {};
+    };
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::operator()(const char_t* buffer, const std::size_t buffer_size)
+    {
+        const char_t* const end = buffer + buffer_size;
+        from_ = buffer;
+        parser_(buffer, buffer_size);
+        if (drop_depth_ == 0U)
+        {
+            if (!parser_.start_tag_pending())
+            {
+                settle();
+                push(from_, end);
+                flush();
+            }
+            else if (pending_)
+                carry_.insert(carry_.end(), from_, end);
+            else
+            {
+                // the start tag is split by the chunk end; keep its head until the observer decides on it
+                const char_t* tag = end;
+                while ((tag > from_) && (*--tag != '<'))
+                    ;
+                push(from_, tag);
+                flush();
+                carry_.assign(tag, end);
+                pending_ = true;
+            }
+        }
+        else
+            flush();
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::finish()
+    {
+        settle();
+        flush();
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end)
+    {
+        if (drop_depth_ != 0U)
+        {
+            ++drop_depth_;
+            return;
+        }
+
+        auto action = xpar_filter_action::keep;
+        observer_->on_element_begin(*this, name, name_end, action);
+        if (action == xpar_filter_action::keep) [[likely]]
+            settle();
+        else
+        {
+            if (pending_)
+                pending_ = false;
+            else
+                push(from_, parser.position() - (name_end - name) - 1);
+
+            if (action == xpar_filter_action::replace)
+                push(replacement_, replacement_end_);
+
+            drop_depth_ = 1U;
+        }
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::on_element_end(xpar_t& parser, const char_t* /*name*/, const char_t* /*name_end*/)
+    {
+        if (drop_depth_ == 0U) [[likely]]
+            settle();
+        else if (--drop_depth_ == 0U)
+            from_ = parser.position();
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::push(const char_t* begin, const char_t* end)
+    {
+        if (begin == end)
+            return;
+
+        if (slice_count_ != 0U)
+        {
+            auto& last = slices_[slice_count_ - 1U];
+            if (last.data + last.size == begin)
+            {
+                last.size += end - begin;
+                return;
+            }
+        }
+
+        if (slice_count_ == slices_.size())
+            flush();
+
+        slices_[slice_count_++] = {begin, static_cast<std::size_t>(end - begin)};
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::flush()
+    {
+        if (slice_count_ != 0U)
+        {
+            sink_->write(slices_.data(), slice_count_);
+            slice_count_ = 0U;
+        }
+    }
+
+    template <typename _Observer, typename _Sink, typename _Config>
+    void xpar_filter<_Observer, _Sink, _Config>::settle()
+    {
+        if (pending_)
+        {
+            pending_ = false;
+            push(carry_.data(), carry_.data() + carry_.size());
+        }
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    /// Filter sink gathering the slices into writev calls on a file descriptor.
+    template <typename _Char = char>
+    class xpar_writev_sink
+    {
+    public:
+        using char_t = _Char;
+        using slice_t = xpar_slice<char_t>;
+
+        constexpr xpar_writev_sink(const int fd) noexcept: fd_(fd) {}
+
+        void write(const slice_t* slices, std::size_t count) noexcept;
+        bool failed() const noexcept { return failed_; }
+
+    protected:
+        enum constant
+        {
+            max_vector_size = 64
+        };
+
+        using vector_t = std::array<::iovec, max_vector_size>;
+
+        vector_t vector_ {};
+        int fd_;
+        bool failed_ {};
+    };
+
+    template <typename _Char>
+    void xpar_writev_sink<_Char>::write(const slice_t* slices, std::size_t count) noexcept
+    {
+        while ((count != 0U) && !failed_)
+        {
+            const std::size_t size = std::min<std::size_t>(count, vector_.size());
+            for (std::size_t i = 0U; i != size; ++i)
+                vector_[i] = {const_cast<_Char*>(slices[i].data), slices[i].size * sizeof(_Char)};
+
+            ::iovec* const end = vector_.data() + size;
+            for (::iovec* item = vector_.data(); item != end;)
+            {
+                const auto written = ::writev(fd_, item, static_cast<int>(end - item));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+
+                    failed_ = true;
+                    return;
+                }
+
+                auto left = static_cast<std::size_t>(written);
+                for (; (item != end) && (left >= item->iov_len); ++item)
+                    left -= item->iov_len;
+
+                if (item != end)
+                {
+                    item->iov_base = static_cast<char*>(item->iov_base) + left;
+                    item->iov_len -= left;
+                }
+            }
+
+            slices += size;
+            count -= size;
+        }
+    }
+#endif
+}
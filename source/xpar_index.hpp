@@ -0,0 +1,287 @@
+/// xpar_index - Sparse element offset index for seeking into large XML documents
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <array>
+    #include <cstdint>
+    #include <fstream>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    struct xpar_index_entry
+    {
+        std::uint64_t offset; // of the element's '<'
+        std::uint32_t line;
+        std::uint16_t depth;
+        std::uint16_t path;
+    };
+
+    /// Side file layout, native byte order:
+    ///     header | entries[entry_count] | path offsets[path_count] | paths
+    /// A path is its depth (uint16) followed by (length (uint8), name) per level, the offsets are relative to the path offsets array.
+    struct xpar_index_header
+    {
+        char magic[8];
+        std::uint64_t entry_count;
+        std::uint64_t path_table_offset;
+        std::uint64_t path_table_size;
+        std::uint32_t path_count;
+        std::uint32_t char_size;
+    };
+
+    constexpr char xpar_index_magic[8] = {'x', 'p', 'a', 'r', 'i', 'd', 'x', '1'};
+
+    /// Observer recording the selected elements during a normal parsing pass; with no selection every element is indexed.
+    template <typename _Config = xpar_default_config>
+    class xpar_index_builder
+    {
+    public:
+        using xpar_t = xpar<xpar_index_builder, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using uint_t = typename xpar_t::uint_t;
+        using string_t = std::basic_string<char_t>;
+        using entry_vector_t = std::vector<xpar_index_entry>;
+
+        static_assert(_Config::max_name_length < 256, "the path table stores the name lengths in one byte");
+
+        void select(const char_t* name, const char_t* name_end) { selection_.emplace_back(name, name_end); }
+
+        const entry_vector_t& entries() const noexcept { return entries_; }
+        std::size_t path_count() const noexcept { return paths_.size(); }
+
+        /// Fails when more than 65536 distinct paths were met, their ids do not fit the entries.
+        bool save(const char* file_path) const;
+        void clear();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+
+    protected:
+        using path_map_t = std::unordered_map<string_t, std::uint16_t>;
+        using string_vector_t = std::vector<string_t>;
+
+        bool selected(const char_t* name, const char_t* name_end) const noexcept;
+
+        string_vector_t selection_ {};
+        string_vector_t paths_ {};
+        path_map_t path_ids_ {};
+        entry_vector_t entries_ {};
+        string_t key_ {};
+        bool overflow_ {};
+    };
+
+    template <typename _Config>
+    bool xpar_index_builder<_Config>::selected(const char_t* name, const char_t* name_end) const noexcept
+    {
+        if (selection_.empty())
+            return true;
+
+        const std::size_t length = name_end - name;
+        for (const auto& item: selection_)
+            if ((item.size() == length) && std::equal(name, name_end, item.data()))
+                return true;
+
+        return false;
+    }
+
+    template <typename _Config>
+    void xpar_index_builder<_Config>::on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end)
+    {
+        if (!selected(name, name_end))
+            return;
+
+        // the key holds the open element names, each one prefixed by its length
+        const uint_t depth = parser.stack_size();
+        key_.clear();
+        for (uint_t i = 1U; i <= depth; ++i)
+        {
+            const char_t* const item = parser.stack_value(i);
+            const char_t* const item_end = std::find(item, item + _Config::max_name_length, char_t {});
+            key_ += static_cast<char_t>(item_end - item);
+            key_.append(item, item_end);
+        }
+
+        auto found = path_ids_.find(key_);
+        if (found == path_ids_.end())
+        {
+            if (paths_.size() > 0xFFFFU) [[unlikely]]
+            {
+                overflow_ = true;
+                return;
+            }
+
+            found = path_ids_.emplace(key_, static_cast<std::uint16_t>(paths_.size())).first;
+            paths_.push_back(key_);
+        }
+
+        entries_.push_back({parser.tag_offset(), parser.line(), static_cast<std::uint16_t>(depth), found->second});
+    }
+
+    template <typename _Config>
+    bool xpar_index_builder<_Config>::save(const char* file_path) const
+    {
+        if (overflow_)
+            return false;
+
+        std::vector<std::uint32_t> path_offsets;
+        std::vector<char> path_data;
+        path_offsets.reserve(paths_.size());
+        for (const auto& path: paths_)
+        {
+            path_offsets.push_back(static_cast<std::uint32_t>(sizeof(std::uint32_t) * paths_.size() + path_data.size()));
+            std::uint16_t depth = 0U;
+            for (std::size_t i = 0U; i < path.size(); i += 1U + static_cast<std::uint8_t>(path[i]))
+                ++depth;
+
+            const auto begin = path_data.size();
+            path_data.resize(begin + sizeof(depth) + path.size() * sizeof(char_t));
+            std::memcpy(path_data.data() + begin, &depth, sizeof(depth));
+            char* out = path_data.data() + begin + sizeof(depth);
+            for (std::size_t i = 0U, length; i < path.size(); i += 1U + length)
+            {
+                length = static_cast<std::uint8_t>(path[i]);
+                *out++ = static_cast<char>(length);
+                std::memcpy(out, path.data() + i + 1U, sizeof(char_t) * length);
+                out += sizeof(char_t) * length;
+            }
+
+            path_data.resize(out - path_data.data());
+        }
+
+        xpar_index_header header {};
+        std::copy(std::begin(xpar_index_magic), std::end(xpar_index_magic), header.magic);
+        header.entry_count = entries_.size();
+        header.path_table_offset = sizeof(header) + sizeof(xpar_index_entry) * entries_.size();
+        header.path_table_size = sizeof(std::uint32_t) * path_offsets.size() + path_data.size();
+        header.path_count = static_cast<std::uint32_t>(paths_.size());
+        header.char_size = sizeof(char_t);
+
+        std::ofstream file(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries_.data()), sizeof(xpar_index_entry) * entries_.size());
+        file.write(reinterpret_cast<const char*>(path_offsets.data()), sizeof(std::uint32_t) * path_offsets.size());
+        file.write(path_data.data(), path_data.size());
+        return static_cast<bool>(file);
+    }
+
+    template <typename _Config>
+    void xpar_index_builder<_Config>::clear()
+    {
+        paths_.clear();
+        path_ids_.clear();
+        entries_.clear();
+        overflow_ = false;
+    }
+
+    /// Read-only view of an index side file loaded or mapped in memory.
+    template <typename _Char = char>
+    class xpar_index_view
+    {
+    public:
+        using char_t = _Char;
+
+        xpar_index_view(const void* const data, const std::size_t size) noexcept;
+
+        bool valid() const noexcept { return header_ != nullptr; }
+        std::size_t size() const noexcept { return valid() ? static_cast<std::size_t>(header_->entry_count) : 0U; }
+        const xpar_index_entry* begin() const noexcept { return entries_; }
+        const xpar_index_entry* end() const noexcept { return entries_ + size(); }
+        std::size_t path_count() const noexcept { return valid() ? header_->path_count : 0U; }
+
+        /// Calls function(name, name_end) for each level of the path, from the root to the indexed element; returns false for an
+        /// unknown path or one that does not fit the path table.
+        template <typename _Function>
+        bool for_each_name(const std::uint16_t path, _Function function) const;
+
+        /// Positions the parser at the entry's element, with its ancestors as open elements;
+        /// the caller then feeds the input starting at entry.offset.
+        template <typename _Parser>
+        bool seek(_Parser& parser, const xpar_index_entry& entry) const;
+
+    protected:
+        const unsigned char* path(const std::uint16_t path) const noexcept;
+
+        const xpar_index_header* header_ {};
+        const xpar_index_entry* entries_ {};
+        const unsigned char* path_table_ {};
+    };
+
+    template <typename _Char>
+    xpar_index_view<_Char>::xpar_index_view(const void* const data, const std::size_t size) noexcept
+    {
+        const auto header = static_cast<const xpar_index_header*>(data);
+        // the sizes come from the file: each one is compared with what is left, so that a corrupted header cannot wrap around
+        if ((size < sizeof(xpar_index_header)) || !std::equal(std::begin(xpar_index_magic), std::end(xpar_index_magic), header->magic) ||
+            (header->char_size != sizeof(char_t)) ||
+            (header->entry_count > (size - sizeof(xpar_index_header)) / sizeof(xpar_index_entry)) ||
+            (header->path_table_offset != sizeof(xpar_index_header) + sizeof(xpar_index_entry) * header->entry_count) ||
+            (header->path_table_size > size - header->path_table_offset) ||
+            (header->path_count > header->path_table_size / sizeof(std::uint32_t)))
+            return;
+
+        header_ = header;
+        entries_ = reinterpret_cast<const xpar_index_entry*>(header + 1);
+        path_table_ = static_cast<const unsigned char*>(data) + header->path_table_offset;
+    }
+
+    template <typename _Char>
+    const unsigned char* xpar_index_view<_Char>::path(const std::uint16_t path) const noexcept
+    {
+        if (path >= path_count())
+            return nullptr;
+
+        std::uint32_t offset;
+        std::memcpy(&offset, path_table_ + sizeof(offset) * path, sizeof(offset));
+        return offset < header_->path_table_size ? path_table_ + offset : nullptr;
+    }
+
+    template <typename _Char>
+    template <typename _Function>
+    bool xpar_index_view<_Char>::for_each_name(const std::uint16_t path_id, _Function function) const
+    {
+        const unsigned char* in = path(path_id);
+        const unsigned char* const end = path_table_ + header_->path_table_size;
+        std::uint16_t depth;
+        if (!in || (static_cast<std::size_t>(end - in) < sizeof(depth)))
+            return false;
+
+        std::memcpy(&depth, in, sizeof(depth));
+        in += sizeof(depth);
+        std::array<char_t, 256U> name;
+        for (; depth != 0U; --depth)
+        {
+            // the names may be unaligned for char_t, they are copied
+            const std::size_t length = (in != end) ? *in++ : name.size();
+            if ((length >= name.size()) || (static_cast<std::size_t>(end - in) < sizeof(char_t) * length))
+                return false;
+
+            std::memcpy(name.data(), in, sizeof(char_t) * length);
+            in += sizeof(char_t) * length;
+            function(name.data(), name.data() + length);
+        }
+
+        return true;
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    bool xpar_index_view<_Char>::seek(_Parser& parser, const xpar_index_entry& entry) const
+    {
+        parser.seek(entry.offset, entry.line);
+        bool pushed = true;
+        std::uint16_t level = 0U;
+        const bool read = for_each_name(entry.path,
+                                        [&](const char_t* name, const char_t* name_end)
+                                        {
+                                            if (++level < entry.depth)
+                                                pushed = pushed && parser.push_element(name, name_end);
+                                        });
+        return read && pushed;
+    }
+}
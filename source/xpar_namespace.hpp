@@ -0,0 +1,297 @@
+/// xpar_namespace - Namespace resolution on top of xpar
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /*class namespace_observer_example // on_comment and on_cdata are optional
+    {
+    public:
+        void on_element_begin(namespace_t& parser, const std::uint32_t uri, const char_t* name, const char_t* name_end);
+        void on_element_end(namespace_t& parser, const std::uint32_t uri, const char_t* name, const char_t* name_end);
+        void on_attribute(namespace_t& parser, const std::uint32_t uri, const char_t* name, const char_t* name_end);
+        void on_attribute_value(namespace_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_data(namespace_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_comment(namespace_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_cdata(namespace_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_error(namespace_t& parser, bool& try_continue);
+    };*/
+
+    /// Reports the element and attribute names as (namespace URI id, local name); the URIs are interned once, uri(id) gives the text.
+    /// A start tag is held until its end, then the element is reported with its attributes, the xmlns ones under xmlns_uri with
+    /// the prefix as the local name, or "xmlns" for the default namespace declaration.
+    /// A start tag whose name exceeds the limit is not reported, nor are its attributes.
+    /// Names with an undeclared prefix are reported whole under no_uri.
+    template <typename _Observer, typename _Config = xpar_default_config>
+    class xpar_namespace
+    {
+    public:
+        using observer_t = _Observer;
+        using config_t = _Config;
+        using xpar_t = xpar<xpar_namespace, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using uint_t = typename xpar_t::uint_t;
+        using string_t = std::basic_string<char_t>;
+
+        enum uri_id : std::uint32_t
+        {
+            no_uri,
+            xml_uri,
+            xmlns_uri,
+        };
+
+        xpar_namespace(observer_t* const observer);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { parser_(buffer, buffer_size); }
+
+        xpar_t& parser() noexcept { return parser_; }
+        observer_t* observer() const noexcept { return observer_; }
+
+        std::size_t uri_count() const noexcept { return uris_.size(); }
+        const string_t& uri(const std::uint32_t id) const noexcept { return uris_[id]; }
+
+        void reset();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_start_tag_end(xpar_t& parser, const bool empty);
+        void on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            observer_->on_data(*this, text, text_end, partial);
+        }
+
+        void on_comment(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_cdata(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_error(xpar_t& /*parser*/, bool& try_continue) { observer_->on_error(*this, try_continue); }
+
+    protected:
+        struct attribute_t
+        {
+            std::size_t name;
+            std::size_t name_end;
+            std::size_t value;
+            std::size_t value_end;
+        };
+
+        struct binding_t
+        {
+            string_t prefix;
+            std::uint32_t uri;
+        };
+
+        struct scope_t
+        {
+            std::size_t binding_count;
+            std::uint32_t uri;
+        };
+
+        using tag_buffer_t = std::vector<char_t>;
+        using attribute_vector_t = std::vector<attribute_t>;
+        using binding_vector_t = std::vector<binding_t>;
+        using scope_vector_t = std::vector<scope_t>;
+        using uri_map_t = std::unordered_map<string_t, std::uint32_t>;
+        using uri_vector_t = std::vector<string_t>;
+
+        static const char_t* declared_prefix(const char_t* name, const char_t* name_end) noexcept;
+
+        std::uint32_t intern(const char_t* text, const char_t* text_end);
+        std::uint32_t resolve(const char_t*& name, const char_t* name_end, const bool element) const noexcept;
+        void append(const char_t* text, const char_t* text_end) { tag_.insert(tag_.end(), text, text_end); }
+
+        xpar_t parser_ {this};
+        observer_t* observer_;
+        tag_buffer_t tag_ {};
+        attribute_vector_t attributes_ {};
+        binding_vector_t bindings_ {};
+        scope_vector_t scopes_ {};
+        uri_map_t uri_ids_ {};
+        uri_vector_t uris_ {};
+        std::size_t name_end_ {};
+        bool tag_open_ {}; // between on_element_begin and on_start_tag_end
+    };
+
+    template <typename _Observer, typename _Config>
+    xpar_namespace<_Observer, _Config>::xpar_namespace(observer_t* const observer): observer_(observer)
+    {
+        reset();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::reset()
+    {
+        static const char xml[] = "http://www.w3.org/XML/1998/namespace";
+        static const char xmlns[] = "http://www.w3.org/2000/xmlns/";
+        parser_.reset();
+        tag_.clear();
+        attributes_.clear();
+        tag_open_ = false;
+        bindings_.clear();
+        scopes_.clear();
+        uri_ids_.clear();
+        uris_.clear();
+        const string_t uris[] = {{}, {std::begin(xml), std::end(xml) - 1}, {std::begin(xmlns), std::end(xmlns) - 1}};
+        for (const auto& uri: uris)
+            intern(uri.data(), uri.data() + uri.size());
+        bindings_.push_back({{'x', 'm', 'l'}, xml_uri});
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_namespace<_Observer, _Config>::intern(const char_t* text, const char_t* text_end)
+    {
+        auto found = uri_ids_.find(string_t(text, text_end));
+        if (found == uri_ids_.end())
+        {
+            found = uri_ids_.emplace(string_t(text, text_end), static_cast<std::uint32_t>(uris_.size())).first;
+            uris_.push_back(found->first);
+        }
+
+        return found->second;
+    }
+
+    template <typename _Observer, typename _Config>
+    const typename xpar_namespace<_Observer, _Config>::char_t*
+        xpar_namespace<_Observer, _Config>::declared_prefix(const char_t* name, const char_t* name_end) noexcept
+    {
+        // "xmlns" declares the default namespace, "xmlns:prefix" a prefix; returns nullptr for other names
+        static const char_t xmlns[] = {'x', 'm', 'l', 'n', 's'};
+        const std::size_t length = name_end - name;
+        if ((length < 5U) || !std::equal(xmlns, xmlns + 5, name))
+            return nullptr;
+
+        return (length == 5U) ? name_end : (name[5U] == ':') ? name + 6 : nullptr;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_namespace<_Observer, _Config>::resolve(const char_t*& name, const char_t* name_end,
+                                                              const bool element) const noexcept
+    {
+        const char_t* const colon = std::find(name, name_end, char_t(':'));
+        if ((colon == name_end) && !element)
+            return no_uri;
+
+        // the innermost declaration wins, the bindings are few so a backward scan beats hashing
+        const std::size_t prefix_length = (colon == name_end) ? 0U : colon - name;
+        for (auto binding = bindings_.rbegin(); binding != bindings_.rend(); ++binding)
+            if ((binding->prefix.size() == prefix_length) && std::equal(name, name + prefix_length, binding->prefix.data()))
+            {
+                if (colon != name_end)
+                    name = colon + 1;
+                return binding->uri;
+            }
+
+        return no_uri;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_element_begin(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        tag_.clear();
+        attributes_.clear();
+        append(name, name_end);
+        name_end_ = tag_.size();
+        tag_open_ = true;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        if (!tag_open_)
+            return;
+
+        const std::size_t begin = tag_.size();
+        append(name, name_end);
+        attributes_.push_back({begin, tag_.size(), tag_.size(), tag_.size()});
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end,
+                                                                const bool /*partial*/)
+    {
+        if (!tag_open_ || attributes_.empty())
+            return;
+
+        auto& attribute = attributes_.back();
+        attribute.value = tag_.size();
+        append(text, text_end);
+        attribute.value_end = tag_.size();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_start_tag_end(xpar_t& /*parser*/, const bool /*empty*/)
+    {
+        // the parser went on after a too long element name, which it did not report
+        if (!tag_open_)
+            return;
+
+        tag_open_ = false;
+        const char_t* const tag = tag_.data();
+        scopes_.push_back({bindings_.size(), no_uri});
+        for (const auto& attribute: attributes_)
+            if (const char_t* const prefix = declared_prefix(tag + attribute.name, tag + attribute.name_end))
+                bindings_.push_back({string_t(prefix, tag + attribute.name_end), intern(tag + attribute.value, tag + attribute.value_end)});
+
+        const char_t* name = tag;
+        auto& scope = scopes_.back();
+        scope.uri = resolve(name, tag + name_end_, true);
+        observer_->on_element_begin(*this, scope.uri, name, tag + name_end_);
+        for (const auto& attribute: attributes_)
+        {
+            const char_t* attribute_name = tag + attribute.name;
+            const char_t* const attribute_name_end = tag + attribute.name_end;
+            const char_t* const prefix = declared_prefix(attribute_name, attribute_name_end);
+            const std::uint32_t uri = prefix ? static_cast<std::uint32_t>(xmlns_uri) : resolve(attribute_name, attribute_name_end, false);
+            if (prefix && (prefix != attribute_name_end))
+                attribute_name = prefix;
+
+            observer_->on_attribute(*this, uri, attribute_name, attribute_name_end);
+            observer_->on_attribute_value(*this, tag + attribute.value, tag + attribute.value_end, false);
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_element_end(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        if (scopes_.empty())
+            return;
+
+        const scope_t scope = scopes_.back();
+        scopes_.pop_back();
+        if (name)
+        {
+            const char_t* const colon = std::find(name, name_end, char_t(':'));
+            if ((colon != name_end) && (scope.uri != no_uri))
+                name = colon + 1;
+        }
+
+        observer_->on_element_end(*this, scope.uri, name, name_end);
+        bindings_.resize(scope.binding_count);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_comment(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+    {
+        xpar_detail::call_if(typename xpar_detail::on_comment<observer_t, xpar_namespace> {}, *observer_,
+                             [&](auto& observer) { observer.on_comment(*this, text, text_end, partial); });
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_namespace<_Observer, _Config>::on_cdata(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (xpar_detail::on_cdata<observer_t, xpar_namespace>::value)
+            xpar_detail::call_if(typename xpar_detail::on_cdata<observer_t, xpar_namespace> {}, *observer_,
+                                 [&](auto& observer) { observer.on_cdata(*this, text, text_end, partial); });
+        else
+            observer_->on_data(*this, text, text_end, partial);
+    }
+}
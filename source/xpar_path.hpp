@@ -0,0 +1,269 @@
+/// xpar_path - Path subscriptions on top of xpar
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /*class path_observer_example
+    {
+    public:
+        void on_element_begin(path_filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end);
+        void on_element_end(path_filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end);
+        void on_attribute(path_filter_t& filter, const std::uint32_t path, const char_t* name, const char_t* name_end, const char_t* value,
+                          const char_t* value_end);
+        void on_data(path_filter_t& filter, const std::uint32_t path, const char_t* text, const char_t* text_end, const bool partial);
+        void on_error(path_filter_t& filter, bool& try_continue);
+    };*/
+
+    /// Reports only what the subscribed paths select, e.g. "/codeBook/dataDscr/var/@name" or "//labl": '/' steps to a child,
+    /// "//" to a descendant, '*' matches any name and a final "@name" or "@*" selects attributes instead of the element.
+    /// A selected element is reported with the text inside it, once per path selecting it. The paths are run as bit-parallel
+    /// automata over the element stack; an element no path can go below is skipped by the parser once its start tag is read.
+    template <typename _Observer, typename _Config = xpar_default_config>
+    class xpar_path_filter
+    {
+    public:
+        using observer_t = _Observer;
+        using config_t = _Config;
+        using xpar_t = xpar<xpar_path_filter, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using string_t = std::basic_string<char_t>;
+
+        enum constant : std::uint32_t
+        {
+            max_steps = 63,
+            invalid_path = 0xFFFFFFFFU,
+        };
+
+        xpar_path_filter(observer_t* const observer): observer_(observer) {}
+
+        /// Adds a path before the parsing starts, returns its id, the number of the paths added before, or invalid_path.
+        /// Without text, the elements of the path are reported without the text inside them and may still be skipped below.
+        std::uint32_t subscribe(const char_t* path, const char_t* path_end, const bool text = true);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { parser_(buffer, buffer_size); }
+
+        xpar_t& parser() noexcept { return parser_; }
+        observer_t* observer() const noexcept { return observer_; }
+
+        /// Restarts the parsing, the paths are kept.
+        void reset();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end) { attribute_.assign(name, name_end); }
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_data(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        bool wanted_attribute(const xpar_t& parser, const std::uint32_t element, const std::uint32_t attribute) const noexcept;
+        void on_error(xpar_t& /*parser*/, bool& try_continue) { observer_->on_error(*this, try_continue); }
+
+    protected:
+        using mask_t = std::uint64_t;
+
+        struct step_t
+        {
+            string_t name; // empty for '*'
+            bool descendant;
+        };
+
+        struct path_t
+        {
+            std::vector<step_t> steps;
+            string_t attribute; // empty for "@*"
+            std::uint32_t attribute_hash;
+            bool attributes;
+            bool text;
+            std::size_t open; // selected elements not ended yet
+        };
+
+        static bool matches(const step_t& step, const char_t* name, const char_t* name_end) noexcept;
+        bool selected(const std::size_t index) const noexcept;
+
+        xpar_t parser_ {this};
+        observer_t* observer_;
+        std::vector<path_t> paths_ {};
+        std::vector<mask_t> masks_ {}; // per open element and path, bit i: the first i steps matched it or an ancestor of a descendant step
+        string_t attribute_ {};
+        std::size_t capturing_ {}; // paths with text and selected elements open
+        bool attributes_ {};       // an attribute path selects the current start tag
+    };
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_path_filter<_Observer, _Config>::subscribe(const char_t* path, const char_t* path_end, const bool text)
+    {
+        path_t result {};
+        result.text = text;
+        while (path != path_end)
+        {
+            if (*path != '/')
+                return invalid_path;
+
+            const bool descendant = (path_end - path > 1) && (path[1] == '/');
+            path += descendant ? 2 : 1;
+            const char_t* const name = path;
+            path = std::find(path, path_end, char_t('/'));
+            if (name == path)
+                return invalid_path;
+
+            if (*name == '@')
+            {
+                // "//@name" is read as "//*/@name"
+                if ((path != path_end) || (name + 1 == path))
+                    return invalid_path;
+                if (descendant)
+                    result.steps.push_back({{}, true});
+
+                result.attributes = true;
+                if ((path - name != 2) || (name[1] != '*'))
+                    result.attribute.assign(name + 1, path);
+                result.attribute_hash = xpar_hash(name + 1, path);
+                break;
+            }
+
+            const bool any = (path - name == 1) && (*name == '*');
+            result.steps.push_back({any ? string_t() : string_t(name, path), descendant});
+        }
+
+        // new paths start at the document level, before anything is parsed
+        if (result.steps.empty() || (result.steps.size() > max_steps) || (masks_.size() != paths_.size()))
+            return invalid_path;
+
+        paths_.push_back(std::move(result));
+        masks_.push_back(1U);
+        return static_cast<std::uint32_t>(paths_.size() - 1U);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_path_filter<_Observer, _Config>::reset()
+    {
+        parser_.reset();
+        masks_.assign(paths_.size(), 1U);
+        for (auto& path: paths_)
+            path.open = 0U;
+        capturing_ = 0U;
+        attributes_ = false;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_path_filter<_Observer, _Config>::matches(const step_t& step, const char_t* name, const char_t* name_end) noexcept
+    {
+        return step.name.empty() ||
+               ((step.name.size() == static_cast<std::size_t>(name_end - name)) && std::equal(name, name_end, step.name.data()));
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_path_filter<_Observer, _Config>::selected(const std::size_t index) const noexcept
+    {
+        return ((masks_[masks_.size() - paths_.size() + index] >> paths_[index].steps.size()) & 1U) != 0U;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_path_filter<_Observer, _Config>::on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end)
+    {
+        const std::size_t count = paths_.size();
+        const std::size_t parent = masks_.size() - count;
+        bool reachable = false;
+        attributes_ = false;
+        for (std::size_t i = 0U; i != count; ++i)
+        {
+            auto& path = paths_[i];
+            const std::size_t length = path.steps.size();
+            const mask_t states = masks_[parent + i];
+            mask_t next = 0U;
+            for (std::size_t step = 0U; (step != length) && ((states >> step) != 0U); ++step)
+                if (((states >> step) & 1U) != 0U)
+                {
+                    if (path.steps[step].descendant)
+                        next |= mask_t(1U) << step;
+                    if (matches(path.steps[step], name, name_end))
+                        next |= mask_t(1U) << (step + 1U);
+                }
+
+            masks_.push_back(next);
+            const mask_t last = mask_t(1U) << length;
+            reachable = reachable || ((next & (last - 1U)) != 0U);
+            if ((next & last) == 0U)
+                continue;
+
+            if (path.attributes)
+                attributes_ = true;
+            else
+            {
+                capturing_ += ((path.open++ == 0U) && path.text) ? 1U : 0U;
+                observer_->on_element_begin(*this, static_cast<std::uint32_t>(i), name, name_end);
+            }
+        }
+
+        if (!reachable && (capturing_ == 0U))
+            parser.skip_element();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_path_filter<_Observer, _Config>::on_element_end(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        const std::size_t count = paths_.size();
+        if (masks_.size() == count) [[unlikely]]
+            return;
+
+        for (std::size_t i = 0U; i != count; ++i)
+        {
+            auto& path = paths_[i];
+            if (!path.attributes && selected(i))
+            {
+                observer_->on_element_end(*this, static_cast<std::uint32_t>(i), name, name_end);
+                capturing_ -= ((--path.open == 0U) && path.text) ? 1U : 0U;
+            }
+        }
+
+        masks_.resize(masks_.size() - count);
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_path_filter<_Observer, _Config>::wanted_attribute(const xpar_t& /*parser*/, const std::uint32_t /*element*/,
+                                                                const std::uint32_t attribute) const noexcept
+    {
+        if (!attributes_)
+            return false;
+
+        for (std::size_t i = 0U; i != paths_.size(); ++i)
+        {
+            const auto& path = paths_[i];
+            if (path.attributes && (path.attribute.empty() || (path.attribute_hash == attribute)) && selected(i))
+                return true;
+        }
+
+        return false;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_path_filter<_Observer, _Config>::on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end,
+                                                                  const bool /*partial*/)
+    {
+        const char_t* const name = attribute_.data();
+        for (std::size_t i = 0U; i != paths_.size(); ++i)
+        {
+            const auto& path = paths_[i];
+            if (path.attributes && (path.attribute.empty() || (path.attribute == attribute_)) && selected(i))
+                observer_->on_attribute(*this, static_cast<std::uint32_t>(i), name, name + attribute_.size(), text, text_end);
+        }
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_path_filter<_Observer, _Config>::on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (capturing_ == 0U)
+            return;
+
+        for (std::size_t i = 0U; i != paths_.size(); ++i)
+            if ((paths_[i].open != 0U) && paths_[i].text)
+                observer_->on_data(*this, static_cast<std::uint32_t>(i), text, text_end, partial);
+    }
+}
@@ -0,0 +1,554 @@
+/// xpar_query - Many path queries matched in one pass
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <map>
+    #include <string>
+    #include <tuple>
+    #include <unordered_map>
+    #include <utility>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /*class query_observer_example
+    {
+    public:
+        void on_match(query_set_t& queries, const std::uint32_t query); // once per query and document
+        void on_error(query_set_t& queries, bool& try_continue);
+    };*/
+
+    /// Matches many queries in one pass over a document and reports each matching query once, e.g. to route messages by content.
+    /// A query is a path of element steps, '/' to a child and "//" to a descendant; a step is a name or '*' followed by attribute
+    /// predicates as [@name] or [@name='value'], and the query matches when it selects some element.
+    /// The queries are compiled into one NFA sharing their common prefixes and run as a DFA built lazily from the sets of NFA states
+    /// the documents lead to: an element costs a name lookup and a table step however many queries there are. Only the attributes
+    /// some predicate may test are copied, and the subtrees no query can reach are skipped. Call reset between documents.
+    template <typename _Observer, typename _Config = xpar_default_config>
+    class xpar_query_set
+    {
+    public:
+        using observer_t = _Observer;
+        using config_t = _Config;
+        using xpar_t = xpar<xpar_query_set, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using string_t = std::basic_string<char_t>;
+        using query_vector_t = std::vector<std::uint32_t>;
+
+        enum constant : std::uint32_t
+        {
+            invalid_query = 0xFFFFFFFFU,
+        };
+
+        xpar_query_set(observer_t* const observer);
+
+        /// Adds a query between documents, returns its id, the number of the queries added before, or invalid_query.
+        std::uint32_t add(const char_t* query, const char_t* query_end);
+
+        void operator()(const char_t* buffer, const std::size_t buffer_size) { parser_(buffer, buffer_size); }
+
+        xpar_t& parser() noexcept { return parser_; }
+        observer_t* observer() const noexcept { return observer_; }
+
+        std::size_t query_count() const noexcept { return matched_.size(); }
+        /// The queries matched in the current document, in the order of their first match.
+        const query_vector_t& matches() const noexcept { return matches_; }
+        /// The DFA states built so far, the ones the documents parsed since the last add led to.
+        std::size_t dfa_state_count() const noexcept { return states_.size(); }
+
+        /// Starts a new document, the queries and the DFA built so far are kept.
+        void reset();
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end);
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial);
+        void on_start_tag_end(xpar_t& parser, const bool empty);
+        bool wanted_attribute(const xpar_t& parser, const std::uint32_t element, const std::uint32_t attribute) const noexcept;
+        void on_error(xpar_t& /*parser*/, bool& try_continue) { observer_->on_error(*this, try_continue); }
+
+    protected:
+        enum internal : std::uint32_t
+        {
+            other_name = 0U, // names no query uses
+            any_name = 0xFFFFFFFEU,
+            no_state = 0xFFFFFFFFU,
+        };
+
+        struct predicate_t
+        {
+            string_t attribute;
+            bool has_value;
+            string_t value;
+            std::uint32_t hash;
+
+            bool operator<(const predicate_t& other) const
+            {
+                return std::tie(attribute, has_value, value) < std::tie(other.attribute, other.has_value, other.value);
+            }
+        };
+
+        struct step_t
+        {
+            string_t name; // empty for '*'
+            bool descendant;
+            std::vector<predicate_t> predicates;
+        };
+
+        struct edge_t
+        {
+            std::uint32_t name; // name symbol or any_name
+            std::uint32_t target;
+        };
+
+        struct nfa_state_t
+        {
+            std::vector<edge_t> edges;
+            query_vector_t queries;    // accepted here
+            std::uint32_t predicates;  // group to pass on entering, 0 for none
+            std::uint32_t descendants; // state looping on every element, reached without input
+            bool loop;
+        };
+
+        struct dfa_state_t
+        {
+            std::vector<std::uint32_t> nfa_states; // closed under the loops
+            query_vector_t queries;
+            std::vector<std::uint32_t> next; // candidate per name symbol, sized on the first use
+            std::uint64_t document;           // the queries were reported for this document
+        };
+
+        // the NFA states an element may enter from a DFA state, the gated ones if their predicates hold on its attributes;
+        // a gated state with a value predicate is found by that attribute and value, the others are all tested
+        struct candidate_t
+        {
+            std::vector<std::uint32_t> free;
+            std::vector<std::uint32_t> gated;
+            std::vector<std::uint32_t> unkeyed;
+            std::unordered_map<string_t, std::vector<std::uint32_t>> keyed; // by attribute, '\0', value
+            std::vector<std::uint32_t> attributes;                          // hashes the predicates test, sorted
+            std::map<std::vector<std::uint32_t>, std::uint32_t> states;     // DFA state by the gated states entered
+            std::uint32_t state;                                            // DFA state when no gated state is entered
+        };
+
+        using predicate_group_t = std::vector<predicate_t>;
+        using edge_key_t = std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>;
+
+        bool parse(const char_t* query, const char_t* query_end, std::vector<step_t>& steps) const;
+        std::uint32_t symbol(const string_t& name);
+        std::uint32_t group(predicate_group_t&& predicates);
+        std::uint32_t new_nfa_state(const std::uint32_t predicates, const bool loop);
+        void clear_dfa();
+        std::uint32_t dfa_state(std::vector<std::uint32_t> nfa_states);
+        std::uint32_t build_candidate(const std::uint32_t state, const std::uint32_t name);
+        std::uint32_t enter(candidate_t& candidate);
+        bool holds(const predicate_group_t& predicates) const;
+        static void key(string_t& result, const string_t& attribute, const string_t& value);
+
+        xpar_t parser_ {this};
+        observer_t* observer_;
+
+        std::vector<nfa_state_t> nfa_ {};
+        std::vector<predicate_group_t> groups_ {};
+        std::map<predicate_group_t, std::uint32_t> group_ids_ {};
+        std::map<edge_key_t, std::uint32_t> edge_targets_ {}; // (state, name, predicate group) to the target, shares the prefixes
+        std::unordered_map<string_t, std::uint32_t> symbols_ {};
+
+        std::vector<dfa_state_t> states_ {};
+        std::map<std::vector<std::uint32_t>, std::uint32_t> state_ids_ {};
+        std::vector<candidate_t> candidates_ {};
+
+        std::vector<std::uint32_t> stack_ {};
+        std::vector<std::pair<string_t, string_t>> attributes_ {};
+        std::size_t attribute_count_ {};
+        std::uint32_t candidate_ {no_state};
+        std::vector<std::uint32_t> entered_ {};
+        string_t name_ {};
+        string_t key_ {};
+
+        std::vector<std::uint64_t> matched_ {}; // per query, the document it matched last
+        query_vector_t matches_ {};
+        std::uint64_t document_ {1U};
+    };
+
+    template <typename _Observer, typename _Config>
+    xpar_query_set<_Observer, _Config>::xpar_query_set(observer_t* const observer): observer_(observer)
+    {
+        new_nfa_state(0U, false);
+        groups_.emplace_back();
+        symbols_.emplace(string_t(), other_name);
+        clear_dfa();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::reset()
+    {
+        parser_.reset();
+        stack_.resize(1U);
+        candidate_ = no_state;
+        matches_.clear();
+        ++document_;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_query_set<_Observer, _Config>::parse(const char_t* query, const char_t* query_end, std::vector<step_t>& steps) const
+    {
+        // "/a//b[@c][@d='e']/*": the names end at '/' or '[', the values are quoted and taken as they are
+        const auto name_end = [query_end](const char_t* text)
+        {
+            while ((text != query_end) && (*text != '/') && (*text != '[') && (*text != ']') && (*text != '='))
+                ++text;
+            return text;
+        };
+
+        while (query != query_end)
+        {
+            if (*query != '/')
+                return false;
+
+            step_t step {};
+            step.descendant = (query_end - query > 1) && (query[1] == '/');
+            query += step.descendant ? 2 : 1;
+            const char_t* const name = query;
+            query = name_end(query);
+            if ((name == query) || (*name == '@'))
+                return false;
+            if ((query - name != 1) || (*name != '*'))
+                step.name.assign(name, query);
+
+            while ((query != query_end) && (*query == '['))
+            {
+                if ((query_end - query < 2) || (query[1] != '@'))
+                    return false;
+
+                predicate_t predicate {};
+                const char_t* const attribute = query + 2;
+                query = name_end(attribute);
+                if ((attribute == query) || (query == query_end))
+                    return false;
+
+                predicate.attribute.assign(attribute, query);
+                predicate.hash = xpar_hash(attribute, query);
+                if (*query == '=')
+                {
+                    if ((++query == query_end) || ((*query != '\'') && (*query != '"')))
+                        return false;
+
+                    const char_t* const value = query + 1;
+                    query = std::find(value, query_end, *query);
+                    if (query == query_end)
+                        return false;
+
+                    predicate.has_value = true;
+                    predicate.value.assign(value, query++);
+                }
+
+                if ((query == query_end) || (*query != ']'))
+                    return false;
+
+                ++query;
+                step.predicates.push_back(std::move(predicate));
+            }
+
+            steps.push_back(std::move(step));
+        }
+
+        return !steps.empty();
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::add(const char_t* query, const char_t* query_end)
+    {
+        std::vector<step_t> steps;
+        if ((stack_.size() != 1U) || !parse(query, query_end, steps))
+            return invalid_query;
+
+        std::uint32_t state = 0U;
+        for (auto& step: steps)
+        {
+            if (step.descendant)
+            {
+                if (nfa_[state].descendants == no_state)
+                {
+                    const std::uint32_t descendants = new_nfa_state(0U, true);
+                    nfa_[state].descendants = descendants;
+                }
+
+                state = nfa_[state].descendants;
+            }
+
+            const std::uint32_t name = step.name.empty() ? static_cast<std::uint32_t>(any_name) : symbol(step.name);
+            const std::uint32_t predicates = group(std::move(step.predicates));
+            const auto found = edge_targets_.emplace(edge_key_t(state, name, predicates), 0U);
+            if (found.second)
+            {
+                const std::uint32_t target = new_nfa_state(predicates, false);
+                nfa_[state].edges.push_back({name, target});
+                found.first->second = target;
+            }
+
+            state = found.first->second;
+        }
+
+        const std::uint32_t id = static_cast<std::uint32_t>(matched_.size());
+        nfa_[state].queries.push_back(id);
+        matched_.push_back(0U);
+        clear_dfa();
+        return id;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::symbol(const string_t& name)
+    {
+        return symbols_.emplace(name, static_cast<std::uint32_t>(symbols_.size())).first->second;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::group(predicate_group_t&& predicates)
+    {
+        if (predicates.empty())
+            return 0U;
+
+        std::sort(predicates.begin(), predicates.end());
+        const auto found = group_ids_.emplace(predicates, static_cast<std::uint32_t>(groups_.size()));
+        if (found.second)
+            groups_.push_back(std::move(predicates));
+
+        return found.first->second;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::new_nfa_state(const std::uint32_t predicates, const bool loop)
+    {
+        nfa_.push_back({{}, {}, predicates, no_state, loop});
+        return static_cast<std::uint32_t>(nfa_.size() - 1U);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::clear_dfa()
+    {
+        states_.clear();
+        state_ids_.clear();
+        candidates_.clear();
+        stack_.assign(1U, dfa_state({0U}));
+        candidate_ = no_state;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::dfa_state(std::vector<std::uint32_t> nfa_states)
+    {
+        for (std::size_t i = 0U; i != nfa_states.size(); ++i)
+        {
+            const std::uint32_t descendants = nfa_[nfa_states[i]].descendants;
+            if (descendants != no_state)
+                nfa_states.push_back(descendants);
+        }
+
+        std::sort(nfa_states.begin(), nfa_states.end());
+        nfa_states.erase(std::unique(nfa_states.begin(), nfa_states.end()), nfa_states.end());
+        const auto found = state_ids_.emplace(nfa_states, static_cast<std::uint32_t>(states_.size()));
+        if (!found.second)
+            return found.first->second;
+
+        dfa_state_t state {std::move(nfa_states), {}, {}, 0U};
+        for (const std::uint32_t nfa_state: state.nfa_states)
+        {
+            const auto& queries = nfa_[nfa_state].queries;
+            state.queries.insert(state.queries.end(), queries.begin(), queries.end());
+        }
+
+        std::sort(state.queries.begin(), state.queries.end());
+        states_.push_back(std::move(state));
+        return found.first->second;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::build_candidate(const std::uint32_t state, const std::uint32_t name)
+    {
+        candidate_t candidate {};
+        for (const std::uint32_t nfa_state: states_[state].nfa_states)
+        {
+            const auto& source = nfa_[nfa_state];
+            if (source.loop)
+                candidate.free.push_back(nfa_state);
+
+            for (const auto& edge: source.edges)
+                if ((edge.name == name) || (edge.name == any_name))
+                    (nfa_[edge.target].predicates ? candidate.gated : candidate.free).push_back(edge.target);
+        }
+
+        for (std::uint32_t i = 0U; i != candidate.gated.size(); ++i)
+        {
+            const auto& predicates = groups_[nfa_[candidate.gated[i]].predicates];
+            const auto valued =
+                std::find_if(predicates.begin(), predicates.end(), [](const auto& predicate) { return predicate.has_value; });
+            if (valued == predicates.end())
+                candidate.unkeyed.push_back(i);
+            else
+            {
+                key(key_, valued->attribute, valued->value);
+                candidate.keyed[key_].push_back(i);
+            }
+
+            for (const auto& predicate: predicates)
+                candidate.attributes.push_back(predicate.hash);
+        }
+
+        std::sort(candidate.attributes.begin(), candidate.attributes.end());
+        candidate.attributes.erase(std::unique(candidate.attributes.begin(), candidate.attributes.end()), candidate.attributes.end());
+        candidate.state = dfa_state(candidate.free);
+        candidates_.push_back(std::move(candidate));
+        return static_cast<std::uint32_t>(candidates_.size() - 1U);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::key(string_t& result, const string_t& attribute, const string_t& value)
+    {
+        result.assign(attribute);
+        result.push_back(char_t {});
+        result.append(value);
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_query_set<_Observer, _Config>::holds(const predicate_group_t& predicates) const
+    {
+        const auto attributes_end = attributes_.begin() + attribute_count_;
+        for (const auto& predicate: predicates)
+        {
+            const auto found = std::find_if(attributes_.begin(), attributes_end,
+                                            [&predicate](const auto& attribute) { return attribute.first == predicate.attribute; });
+            if ((found == attributes_end) || (predicate.has_value && (found->second != predicate.value)))
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename _Observer, typename _Config>
+    std::uint32_t xpar_query_set<_Observer, _Config>::enter(candidate_t& candidate)
+    {
+        if (candidate.gated.empty())
+            return candidate.state;
+
+        entered_.clear();
+        for (const std::uint32_t gated: candidate.unkeyed)
+            if (holds(groups_[nfa_[candidate.gated[gated]].predicates]))
+                entered_.push_back(gated);
+
+        if (!candidate.keyed.empty())
+            for (std::size_t i = 0U; i != attribute_count_; ++i)
+            {
+                key(key_, attributes_[i].first, attributes_[i].second);
+                const auto found = candidate.keyed.find(key_);
+                if (found != candidate.keyed.end())
+                    for (const std::uint32_t gated: found->second)
+                        if (holds(groups_[nfa_[candidate.gated[gated]].predicates]))
+                            entered_.push_back(gated);
+            }
+
+        if (entered_.empty())
+            return candidate.state;
+
+        std::sort(entered_.begin(), entered_.end());
+        entered_.erase(std::unique(entered_.begin(), entered_.end()), entered_.end());
+        const auto found = candidate.states.find(entered_);
+        if (found != candidate.states.end())
+            return found->second;
+
+        std::vector<std::uint32_t> nfa_states = candidate.free;
+        for (const std::uint32_t gated: entered_)
+            nfa_states.push_back(candidate.gated[gated]);
+
+        const std::uint32_t state = dfa_state(std::move(nfa_states));
+        candidate.states.emplace(entered_, state);
+        return state;
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::on_element_begin(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        name_.assign(name, name_end);
+        const auto found = symbols_.find(name_);
+        const std::uint32_t symbol = (found == symbols_.end()) ? static_cast<std::uint32_t>(other_name) : found->second;
+        const std::uint32_t state = stack_.back();
+        auto& next = states_[state].next;
+        if (next.empty())
+            next.assign(symbols_.size(), no_state);
+        if (next[symbol] == no_state)
+        {
+            const std::uint32_t candidate = build_candidate(state, symbol);
+            states_[state].next[symbol] = candidate;
+        }
+
+        candidate_ = states_[state].next[symbol];
+        attribute_count_ = 0U;
+    }
+
+    template <typename _Observer, typename _Config>
+    bool xpar_query_set<_Observer, _Config>::wanted_attribute(const xpar_t& /*parser*/, const std::uint32_t /*element*/,
+                                                             const std::uint32_t attribute) const noexcept
+    {
+        if (candidate_ == no_state)
+            return false;
+
+        const auto& attributes = candidates_[candidate_].attributes;
+        return std::binary_search(attributes.begin(), attributes.end(), attribute);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+    {
+        if (attribute_count_ == attributes_.size())
+            attributes_.emplace_back();
+
+        auto& attribute = attributes_[attribute_count_++];
+        attribute.first.assign(name, name_end);
+        attribute.second.clear();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end,
+                                                               const bool /*partial*/)
+    {
+        if (attribute_count_)
+            attributes_[attribute_count_ - 1U].second.append(text, text_end);
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::on_start_tag_end(xpar_t& parser, const bool /*empty*/)
+    {
+        if (candidate_ == no_state) [[unlikely]]
+            return;
+
+        const std::uint32_t state = enter(candidates_[candidate_]);
+        candidate_ = no_state;
+        stack_.push_back(state);
+        auto& entered = states_[state];
+        if (!entered.queries.empty() && (entered.document != document_))
+        {
+            entered.document = document_;
+            for (const std::uint32_t query: entered.queries)
+                if (matched_[query] != document_)
+                {
+                    matched_[query] = document_;
+                    matches_.push_back(query);
+                    observer_->on_match(*this, query);
+                }
+        }
+
+        if (states_[state].nfa_states.empty() || (matches_.size() == matched_.size()))
+            parser.skip_element();
+    }
+
+    template <typename _Observer, typename _Config>
+    void xpar_query_set<_Observer, _Config>::on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/)
+    {
+        if (stack_.size() > 1U)
+            stack_.pop_back();
+    }
+}
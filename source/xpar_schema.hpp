@@ -0,0 +1,748 @@
+/// xpar_schema - Streaming validation against compiled content models
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cstdint>
+    #include <map>
+    #include <string>
+    #include <unordered_map>
+    #include <utility>
+    #include <vector>
+#endif
+
+namespace stdext
+{
+    /// Lexical spaces checked for text and attribute values, with leading and trailing whitespace allowed.
+    enum class xpar_simple_type : std::uint8_t
+    {
+        string,
+        boolean, // true, false, 1 or 0
+        integer, // optional sign and digits
+        decimal, // optional sign, digits with an optional fraction
+        date,    // yyyy-mm-dd
+    };
+
+    enum class xpar_validation_error : std::uint8_t
+    {
+        none,
+        undeclared_element,
+        wrong_root,
+        unexpected_element,
+        incomplete_content,
+        unexpected_text,
+        invalid_text,
+        undeclared_attribute,
+        missing_attribute,
+        invalid_attribute,
+    };
+
+    template <typename _Char>
+    class xpar_validator;
+
+    /// Element declarations compiled ahead of the parsing into one DFA per content model. A content model is written as in a DTD:
+    ///     EMPTY, ANY, (#PCDATA) for text of the element's simple type, (#PCDATA | a | b)* for mixed content, or children built from
+    ///     names, sequences (a, b), choices (a | b) and the ?, * and + occurrences, e.g. "(head, (item | note)*, tail?)".
+    /// The declarations are global as in a DTD; xmlns and xml: attributes are always allowed.
+    template <typename _Char = char>
+    class xpar_schema
+    {
+    public:
+        using char_t = _Char;
+        using string_t = std::basic_string<char_t>;
+
+        /// Returns false when the element is declared already.
+        bool element(const string_t& name, const string_t& content, const xpar_simple_type text = xpar_simple_type::string);
+
+        /// Returns false for an undeclared element, a duplicate or the 65th attribute of an element.
+        bool attribute(const string_t& element, const string_t& name, const bool required,
+                       const xpar_simple_type type = xpar_simple_type::string);
+
+        /// The document element, any declared one when not set.
+        void root(const string_t& name) { root_ = name; }
+
+        /// Builds the automata, returns false when a content model is malformed or names an undeclared element.
+        bool compile();
+
+    protected:
+        friend class xpar_validator<_Char>;
+
+        enum constant : std::uint32_t
+        {
+            no_element = 0xFFFFFFFFU,
+            max_attributes = 64U,
+        };
+
+        enum class content_t : std::uint8_t
+        {
+            empty,
+            any,
+            text,
+            mixed,
+            children,
+        };
+
+        struct attribute_t
+        {
+            string_t name;
+            xpar_simple_type type;
+        };
+
+        struct element_t
+        {
+            string_t name;
+            string_t model;
+            content_t content;
+            xpar_simple_type text;
+            std::uint32_t start;    // DFA state of the children
+            std::uint64_t required; // attribute mask
+            std::vector<attribute_t> attributes;
+        };
+
+        struct state_t
+        {
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> next; // (element, state) sorted by element
+            bool accepting;
+        };
+
+        // Glushkov construction: a position per name occurrence, follow sets between them
+        struct fragment_t
+        {
+            std::vector<std::uint32_t> first;
+            std::vector<std::uint32_t> last;
+            bool nullable;
+        };
+
+        struct positions_t
+        {
+            std::vector<std::uint32_t> symbols;
+            std::vector<std::vector<std::uint32_t>> follow;
+        };
+
+        static bool is_space(const char_t c) noexcept { return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'); }
+        static void merge(std::vector<std::uint32_t>& to, const std::vector<std::uint32_t>& from);
+        static std::uint8_t step(const xpar_simple_type type, const std::uint8_t state, const char_t c) noexcept;
+        static bool accepts(const xpar_simple_type type, const std::uint8_t state) noexcept;
+
+        bool parse_particle(const char_t*& model, const char_t* model_end, positions_t& positions, fragment_t& fragment) const;
+        bool compile(element_t& element);
+        std::uint32_t find(const char_t* name, const char_t* name_end) const;
+        std::uint32_t lookup(const char_t* name, const char_t* name_end) const noexcept;
+
+        std::vector<element_t> elements_ {};
+        std::unordered_map<string_t, std::uint32_t> element_ids_ {};
+        std::vector<state_t> states_ {};
+        std::vector<std::uint32_t> slots_ {}; // open addressing by xpar_hash of the name, for the validation
+        string_t root_ {};
+        std::uint32_t root_id_ {no_element};
+        bool compiled_ {};
+    };
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::element(const string_t& name, const string_t& content, const xpar_simple_type text)
+    {
+        if (!element_ids_.emplace(name, static_cast<std::uint32_t>(elements_.size())).second)
+            return false;
+
+        elements_.push_back({name, content, content_t::empty, text, 0U, 0U, {}});
+        compiled_ = false;
+        return true;
+    }
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::attribute(const string_t& element, const string_t& name, const bool required, const xpar_simple_type type)
+    {
+        const auto found = element_ids_.find(element);
+        if (found == element_ids_.end())
+            return false;
+
+        auto& attributes = elements_[found->second].attributes;
+        if ((attributes.size() == max_attributes) ||
+            std::any_of(attributes.begin(), attributes.end(), [&name](const attribute_t& attribute) { return attribute.name == name; }))
+            return false;
+
+        if (required)
+            elements_[found->second].required |= std::uint64_t(1U) << attributes.size();
+        attributes.push_back({name, type});
+        return true;
+    }
+
+    template <typename _Char>
+    std::uint32_t xpar_schema<_Char>::find(const char_t* name, const char_t* name_end) const
+    {
+        const auto found = element_ids_.find(string_t(name, name_end));
+        return (found == element_ids_.end()) ? static_cast<std::uint32_t>(no_element) : found->second;
+    }
+
+    template <typename _Char>
+    std::uint32_t xpar_schema<_Char>::lookup(const char_t* name, const char_t* name_end) const noexcept
+    {
+        const std::size_t mask = slots_.size() - 1U;
+        const std::size_t length = name_end - name;
+        for (std::size_t slot = xpar_hash(name, name_end) & mask;; slot = (slot + 1U) & mask)
+        {
+            const std::uint32_t element = slots_[slot];
+            if ((element == no_element) ||
+                ((elements_[element].name.size() == length) && std::equal(name, name_end, elements_[element].name.data())))
+                return element;
+        }
+    }
+
+    template <typename _Char>
+    void xpar_schema<_Char>::merge(std::vector<std::uint32_t>& to, const std::vector<std::uint32_t>& from)
+    {
+        to.insert(to.end(), from.begin(), from.end());
+        std::sort(to.begin(), to.end());
+        to.erase(std::unique(to.begin(), to.end()), to.end());
+    }
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::parse_particle(const char_t*& model, const char_t* model_end, positions_t& positions,
+                                            fragment_t& fragment) const
+    {
+        const auto skip_space = [&model, model_end]()
+        {
+            while ((model != model_end) && is_space(*model))
+                ++model;
+        };
+
+        skip_space();
+        if (model == model_end)
+            return false;
+
+        if (*model == '(')
+        {
+            ++model;
+            if (!parse_particle(model, model_end, positions, fragment))
+                return false;
+
+            skip_space();
+            const char_t separator = ((model != model_end) && ((*model == ',') || (*model == '|'))) ? *model : char_t(')');
+            while ((model != model_end) && (*model == separator) && (separator != ')'))
+            {
+                ++model;
+                fragment_t next {};
+                if (!parse_particle(model, model_end, positions, next))
+                    return false;
+
+                if (separator == ',')
+                {
+                    for (const std::uint32_t position: fragment.last)
+                        merge(positions.follow[position], next.first);
+                    if (fragment.nullable)
+                        merge(fragment.first, next.first);
+                    if (next.nullable)
+                        merge(next.last, fragment.last);
+                    fragment.last = std::move(next.last);
+                    fragment.nullable = fragment.nullable && next.nullable;
+                }
+                else
+                {
+                    merge(fragment.first, next.first);
+                    merge(fragment.last, next.last);
+                    fragment.nullable = fragment.nullable || next.nullable;
+                }
+
+                skip_space();
+            }
+
+            if ((model == model_end) || (*model != ')'))
+                return false;
+
+            ++model;
+        }
+        else
+        {
+            const char_t* const name = model;
+            while ((model != model_end) && !is_space(*model) && (*model != ',') && (*model != '|') && (*model != '(') &&
+                   (*model != ')') && (*model != '?') && (*model != '*') && (*model != '+'))
+                ++model;
+
+            const std::uint32_t symbol = find(name, model);
+            if (symbol == no_element)
+                return false;
+
+            const std::uint32_t position = static_cast<std::uint32_t>(positions.symbols.size());
+            positions.symbols.push_back(symbol);
+            positions.follow.emplace_back();
+            fragment = {{position}, {position}, false};
+        }
+
+        if ((model != model_end) && ((*model == '*') || (*model == '+')))
+            for (const std::uint32_t position: fragment.last)
+                merge(positions.follow[position], fragment.first);
+        if ((model != model_end) && ((*model == '*') || (*model == '?') || (*model == '+')))
+            fragment.nullable = fragment.nullable || (*model++ != '+');
+
+        return true;
+    }
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::compile(element_t& element)
+    {
+        static const char_t pcdata[] = {'#', 'P', 'C', 'D', 'A', 'T', 'A'};
+        static const char_t empty[] = {'E', 'M', 'P', 'T', 'Y'};
+        static const char_t any[] = {'A', 'N', 'Y'};
+        const string_t& model = element.model;
+        const auto is = [&model](const char_t* keyword, const std::size_t size)
+        { return (model.size() == size) && std::equal(keyword, keyword + size, model.data()); };
+
+        if (is(empty, sizeof(empty) / sizeof(char_t)) || is(any, sizeof(any) / sizeof(char_t)))
+        {
+            element.content = (model.size() == 3U) ? content_t::any : content_t::empty;
+            return true;
+        }
+
+        // (#PCDATA) is text, (#PCDATA | a | b)* is rewritten as (a | b)*
+        positions_t positions {};
+        fragment_t fragment {};
+        string_t children = model;
+        const std::size_t keyword = children.find(string_t(pcdata, pcdata + 7));
+        element.content = content_t::children;
+        if (keyword != string_t::npos)
+        {
+            const std::size_t close = children.rfind(')');
+            if ((close == string_t::npos) || (children.find_first_not_of(string_t {' ', '\t', '\r', '\n', '('}) != keyword))
+                return false;
+
+            const string_t tail = children.substr(close + 1U);
+            element.content = (children.find('|') == string_t::npos) ? content_t::text : content_t::mixed;
+            if ((tail != string_t(1U, '*')) && ((element.content == content_t::mixed) || !tail.empty()))
+                return false;
+            if (element.content == content_t::text)
+                return true;
+
+            children.erase(0U, keyword + 7U);
+            const std::size_t bar = children.find_first_not_of(string_t {' ', '\t', '\r', '\n'});
+            if ((bar == string_t::npos) || (children[bar] != '|'))
+                return false;
+
+            children[bar] = '(';
+        }
+
+        const char_t* text = children.data();
+        const char_t* const text_end = text + children.size();
+        if (!parse_particle(text, text_end, positions, fragment))
+            return false;
+        while ((text != text_end) && is_space(*text))
+            ++text;
+        if (text != text_end)
+            return false;
+
+        // subset construction, the start state is the set holding the extra position
+        const std::uint32_t start = static_cast<std::uint32_t>(positions.symbols.size());
+        positions.follow.push_back(fragment.first);
+        std::map<std::vector<std::uint32_t>, std::uint32_t> ids {{{start}, static_cast<std::uint32_t>(states_.size())}};
+        std::vector<std::vector<std::uint32_t>> pending {{start}};
+        element.start = static_cast<std::uint32_t>(states_.size());
+        states_.push_back({{}, fragment.nullable});
+        while (!pending.empty())
+        {
+            const std::vector<std::uint32_t> set = std::move(pending.back());
+            pending.pop_back();
+            const std::uint32_t state = ids[set];
+            std::map<std::uint32_t, std::vector<std::uint32_t>> next;
+            for (const std::uint32_t position: set)
+                for (const std::uint32_t target: positions.follow[position])
+                    next[positions.symbols[target]].push_back(target);
+
+            for (auto& item: next)
+            {
+                std::sort(item.second.begin(), item.second.end());
+                item.second.erase(std::unique(item.second.begin(), item.second.end()), item.second.end());
+                const auto found = ids.emplace(item.second, static_cast<std::uint32_t>(states_.size()));
+                if (found.second)
+                {
+                    const auto& last = fragment.last;
+                    const bool accepting = std::any_of(item.second.begin(), item.second.end(), [&last](const std::uint32_t position)
+                                                       { return std::binary_search(last.begin(), last.end(), position); });
+                    states_.push_back({{}, accepting});
+                    pending.push_back(item.second);
+                }
+
+                states_[state].next.emplace_back(item.first, found.first->second);
+            }
+        }
+
+        return true;
+    }
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::compile()
+    {
+        states_.clear();
+        compiled_ = false;
+        for (auto& element: elements_)
+            if (!compile(element))
+                return false;
+
+        std::size_t size = 16U;
+        while (size < 2U * elements_.size())
+            size *= 2U;
+
+        slots_.assign(size, no_element);
+        for (std::uint32_t i = 0U; i != elements_.size(); ++i)
+        {
+            const string_t& name = elements_[i].name;
+            std::size_t slot = xpar_hash(name.data(), name.data() + name.size()) & (size - 1U);
+            while (slots_[slot] != no_element)
+                slot = (slot + 1U) & (size - 1U);
+            slots_[slot] = i;
+        }
+
+        root_id_ = root_.empty() ? static_cast<std::uint32_t>(no_element) : find(root_.data(), root_.data() + root_.size());
+        compiled_ = root_.empty() || (root_id_ != no_element);
+        return compiled_;
+    }
+
+    template <typename _Char>
+    std::uint8_t xpar_schema<_Char>::step(const xpar_simple_type type, const std::uint8_t state, const char_t c) noexcept
+    {
+        // state 0 reads the leading whitespace, trailing reads the one after an accepted value, invalid is final
+        const std::uint8_t trailing = 0xFEU;
+        const std::uint8_t invalid = 0xFFU;
+
+        if ((state == invalid) || (type == xpar_simple_type::string))
+            return state;
+        if ((state == 0U) && is_space(c))
+            return state;
+        if (is_space(c))
+            return (state == trailing) || accepts(type, state) ? trailing : invalid;
+        if (state == trailing)
+            return invalid;
+
+        const bool digit = (c >= '0') && (c <= '9');
+        switch (type)
+        {
+            case xpar_simple_type::boolean:
+            {
+                // the words start differently, a state is 1 + 8 * word + matched length
+                static const char words[4][6] = {"true", "false", "1", "0"};
+                if (state == 0U)
+                {
+                    for (std::uint8_t word = 0U; word != 4U; ++word)
+                        if (c == words[word][0])
+                            return static_cast<std::uint8_t>(2U + 8U * word);
+                    return invalid;
+                }
+
+                const std::uint8_t word = (state - 1U) / 8U;
+                const std::uint8_t length = (state - 1U) % 8U;
+                return (words[word][length] == c) ? static_cast<std::uint8_t>(state + 1U) : static_cast<std::uint8_t>(invalid);
+            }
+            case xpar_simple_type::integer:
+                // 1 sign, 2 digits
+                return digit ? std::uint8_t(2U) : ((state == 0U) && ((c == '+') || (c == '-'))) ? std::uint8_t(1U) : invalid;
+            case xpar_simple_type::decimal:
+                // 1 sign, 2 integer digits, 3 point after digits, 4 fraction digits, 5 point without integer digits
+                if (digit)
+                    return (state <= 2U) ? 2U : 4U;
+                if (c == '.')
+                    return (state == 2U) ? std::uint8_t(3U) : (state <= 1U) ? std::uint8_t(5U) : invalid;
+                return ((state == 0U) && ((c == '+') || (c == '-'))) ? std::uint8_t(1U) : invalid;
+            case xpar_simple_type::date:
+            {
+                // 1 + matched length of yyyy-mm-dd
+                static const char pattern[] = "dddd-dd-dd";
+                const std::uint8_t length = (state == 0U) ? 0U : state - 1U;
+                if (length == 10U)
+                    return invalid;
+                return ((pattern[length] == 'd') ? digit : (c == '-')) ? static_cast<std::uint8_t>(length + 2U) : invalid;
+            }
+            default:
+                break;
+        }
+
+        return invalid;
+    }
+
+    template <typename _Char>
+    bool xpar_schema<_Char>::accepts(const xpar_simple_type type, const std::uint8_t state) noexcept
+    {
+        if (state == 0xFEU)
+            return true;
+        if (state == 0xFFU)
+            return false;
+
+        switch (type)
+        {
+            case xpar_simple_type::string:
+                return true;
+            case xpar_simple_type::boolean:
+                return (state == 5U) || (state == 14U) || (state == 18U) || (state == 26U);
+            case xpar_simple_type::integer:
+                return state == 2U;
+            case xpar_simple_type::decimal:
+                return (state >= 2U) && (state <= 4U);
+            case xpar_simple_type::date:
+                return state == 11U;
+        }
+
+        return false;
+    }
+
+    /// Validates the events of one document against a compiled schema. It is an xpar observer by itself, or an inline policy of
+    /// another observer forwarding its callbacks to it. Per open element it keeps the declaration, the content automaton state and
+    /// the attributes seen; a step is a name lookup and a binary search among the few transitions of the state. The validation
+    /// goes on after an error, the subtree of an undeclared element is not checked.
+    template <typename _Char = char>
+    class xpar_validator
+    {
+    public:
+        using char_t = _Char;
+        using schema_t = xpar_schema<_Char>;
+        using string_t = typename schema_t::string_t;
+
+        xpar_validator(const schema_t* const schema): schema_(schema) { reset(); }
+
+        bool valid() const noexcept { return error_count_ == 0U; }
+        std::size_t error_count() const noexcept { return error_count_; }
+
+        /// The first error, where the parser was and the name of the element or attribute concerned.
+        xpar_validation_error error() const noexcept { return error_; }
+        std::uint64_t error_line() const noexcept { return error_line_; }
+        std::uint64_t error_column() const noexcept { return error_column_; }
+        const string_t& error_name() const noexcept { return error_name_; }
+
+        void reset();
+
+        template <typename _Parser>
+        void on_element_begin(_Parser& parser, const char_t* name, const char_t* name_end);
+        template <typename _Parser>
+        void on_element_end(_Parser& parser, const char_t* name, const char_t* name_end);
+        template <typename _Parser>
+        void on_attribute(_Parser& parser, const char_t* name, const char_t* name_end);
+        template <typename _Parser>
+        void on_attribute_value(_Parser& parser, const char_t* text, const char_t* text_end, const bool partial);
+        template <typename _Parser>
+        void on_start_tag_end(_Parser& parser, const bool empty);
+        template <typename _Parser>
+        void on_data(_Parser& parser, const char_t* text, const char_t* text_end, const bool partial);
+
+    protected:
+        using content_t = typename schema_t::content_t;
+
+        enum constant : std::uint32_t
+        {
+            no_element = schema_t::no_element,
+            no_attribute = 0xFFFFFFFFU,
+        };
+
+        struct frame_t
+        {
+            std::uint32_t element;
+            std::uint32_t state;    // children automaton
+            std::uint64_t seen;     // attributes
+            std::uint8_t text;      // simple type state of the text
+        };
+
+        template <typename _Parser>
+        void fail(_Parser& parser, const xpar_validation_error error, const char_t* name, const char_t* name_end);
+
+        const schema_t* schema_;
+        std::vector<frame_t> frames_ {};
+        std::size_t unchecked_depth_ {}; // inside an undeclared element
+        std::uint32_t attribute_ {no_attribute};
+        std::uint8_t value_ {};
+
+        xpar_validation_error error_ {};
+        std::size_t error_count_ {};
+        std::uint64_t error_line_ {};
+        std::uint64_t error_column_ {};
+        string_t error_name_ {};
+    };
+
+    template <typename _Char>
+    void xpar_validator<_Char>::reset()
+    {
+        frames_.clear();
+        frames_.reserve(32U);
+        unchecked_depth_ = 0U;
+        attribute_ = no_attribute;
+        error_ = {};
+        error_count_ = 0U;
+        error_line_ = error_column_ = 0U;
+        error_name_.clear();
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::fail(_Parser& parser, const xpar_validation_error error, const char_t* name, const char_t* name_end)
+    {
+        if (error_count_++ != 0U)
+            return;
+
+        error_ = error;
+        error_line_ = parser.line();
+        error_column_ = parser.column();
+        if (name)
+            error_name_.assign(name, name_end);
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_element_begin(_Parser& parser, const char_t* name, const char_t* name_end)
+    {
+        attribute_ = no_attribute;
+        if (unchecked_depth_ != 0U)
+        {
+            ++unchecked_depth_;
+            return;
+        }
+
+        const std::uint32_t element = schema_->compiled_ ? schema_->lookup(name, name_end) : static_cast<std::uint32_t>(no_element);
+        if (element == no_element)
+        {
+            fail(parser, xpar_validation_error::undeclared_element, name, name_end);
+            unchecked_depth_ = 1U;
+            return;
+        }
+
+        if (frames_.empty())
+        {
+            if ((schema_->root_id_ != no_element) && (element != schema_->root_id_))
+                fail(parser, xpar_validation_error::wrong_root, name, name_end);
+        }
+        else
+        {
+            auto& parent = frames_.back();
+            switch (schema_->elements_[parent.element].content)
+            {
+                case content_t::any:
+                    break;
+                case content_t::mixed:
+                case content_t::children:
+                {
+                    const auto& next = schema_->states_[parent.state].next;
+                    const auto transition = std::lower_bound(next.begin(), next.end(), std::make_pair(element, std::uint32_t(0U)));
+                    if ((transition != next.end()) && (transition->first == element))
+                        parent.state = transition->second;
+                    else
+                        fail(parser, xpar_validation_error::unexpected_element, name, name_end);
+                    break;
+                }
+                default:
+                    fail(parser, xpar_validation_error::unexpected_element, name, name_end);
+                    break;
+            }
+        }
+
+        frames_.push_back({element, schema_->elements_[element].start, 0U, 0U});
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_attribute(_Parser& parser, const char_t* name, const char_t* name_end)
+    {
+        static const char_t xml[] = {'x', 'm', 'l', ':'};
+        static const char_t xmlns[] = {'x', 'm', 'l', 'n', 's', ':'};
+        attribute_ = no_attribute;
+        if ((unchecked_depth_ != 0U) || frames_.empty())
+            return;
+
+        const std::size_t length = name_end - name;
+        auto& frame = frames_.back();
+        const auto& attributes = schema_->elements_[frame.element].attributes;
+        for (std::uint32_t i = 0U; i != attributes.size(); ++i)
+            if ((attributes[i].name.size() == length) && std::equal(name, name_end, attributes[i].name.data()))
+            {
+                attribute_ = i;
+                frame.seen |= std::uint64_t(1U) << i;
+                value_ = 0U;
+                return;
+            }
+
+        // xmlns, xmlns:prefix and xml:name only, not every name starting with xml
+        const bool reserved = ((length > 4U) && std::equal(xml, xml + 4, name)) || ((length == 5U) && std::equal(xmlns, xmlns + 5, name)) ||
+                              ((length > 6U) && std::equal(xmlns, xmlns + 6, name));
+        if (!reserved)
+            fail(parser, xpar_validation_error::undeclared_attribute, name, name_end);
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_attribute_value(_Parser& parser, const char_t* text, const char_t* text_end, const bool partial)
+    {
+        if (attribute_ == no_attribute)
+            return;
+
+        const auto& attribute = schema_->elements_[frames_.back().element].attributes[attribute_];
+        if (attribute.type == xpar_simple_type::string)
+            return;
+
+        for (; text != text_end; ++text)
+            value_ = schema_t::step(attribute.type, value_, *text);
+
+        if (!partial && !schema_t::accepts(attribute.type, value_))
+            fail(parser, xpar_validation_error::invalid_attribute, attribute.name.data(), attribute.name.data() + attribute.name.size());
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_start_tag_end(_Parser& parser, const bool /*empty*/)
+    {
+        attribute_ = no_attribute;
+        if ((unchecked_depth_ != 0U) || frames_.empty())
+            return;
+
+        const auto& frame = frames_.back();
+        const auto& element = schema_->elements_[frame.element];
+        if ((element.required & ~frame.seen) != 0U)
+            fail(parser, xpar_validation_error::missing_attribute, element.name.data(), element.name.data() + element.name.size());
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_data(_Parser& parser, const char_t* text, const char_t* text_end, const bool /*partial*/)
+    {
+        if ((unchecked_depth_ != 0U) || frames_.empty())
+            return;
+
+        auto& frame = frames_.back();
+        const auto& element = schema_->elements_[frame.element];
+        switch (element.content)
+        {
+            case content_t::text:
+                if (element.text != xpar_simple_type::string)
+                    for (; text != text_end; ++text)
+                        frame.text = schema_t::step(element.text, frame.text, *text);
+                break;
+            case content_t::empty:
+            case content_t::children:
+                // whitespace only, the reported pieces are checked one by one
+                if (std::any_of(text, text_end, [](const char_t c) { return !schema_t::is_space(c); }) ||
+                    ((element.content == content_t::empty) && (text != text_end)))
+                    fail(parser, xpar_validation_error::unexpected_text, element.name.data(), element.name.data() + element.name.size());
+                break;
+            default:
+                break;
+        }
+    }
+
+    template <typename _Char>
+    template <typename _Parser>
+    void xpar_validator<_Char>::on_element_end(_Parser& parser, const char_t* /*name*/, const char_t* /*name_end*/)
+    {
+        attribute_ = no_attribute;
+        if (unchecked_depth_ != 0U)
+        {
+            --unchecked_depth_;
+            return;
+        }
+
+        if (frames_.empty())
+            return;
+
+        const auto& frame = frames_.back();
+        const auto& element = schema_->elements_[frame.element];
+        const char_t* const name = element.name.data();
+        if (((element.content == content_t::children) || (element.content == content_t::mixed)) && !schema_->states_[frame.state].accepting)
+            fail(parser, xpar_validation_error::incomplete_content, name, name + element.name.size());
+        else if ((element.content == content_t::text) && !schema_t::accepts(element.text, frame.text))
+            fail(parser, xpar_validation_error::invalid_text, name, name + element.name.size());
+
+        frames_.pop_back();
+    }
+}
@@ -0,0 +1,427 @@
+/// xpar_value - Conversion of text and attribute values to numbers, booleans and dates
+/// Copyright (c) Flaviu Cibu. All rights reserved.
+
+#pragma once
+#ifndef PCH
+    #include "xpar.hpp"
+    #include <algorithm>
+    #include <cerrno>
+    #include <clocale>
+    #include <cmath>
+    #include <cstdint>
+    #include <cstdlib>
+    #include <cstring>
+    #include <limits>
+    #include <string>
+    #include <type_traits>
+#endif
+
+namespace stdext
+{
+    /// ISO 8601 date with an optional time and UTC offset, as in xs:date and xs:dateTime.
+    struct xpar_date_time
+    {
+        std::int32_t year;
+        std::uint8_t month;
+        std::uint8_t day;
+        std::uint8_t hour;
+        std::uint8_t minute;
+        std::uint8_t second;
+        std::uint32_t nanosecond;
+        std::int16_t offset; // minutes east of UTC
+        bool has_time;
+        bool has_offset;
+
+        /// Days since 1970-01-01.
+        std::int64_t days() const noexcept
+        {
+            // civil calendar to day count, the year starting in March
+            const std::int64_t y = static_cast<std::int64_t>(year) - (month <= 2U ? 1 : 0);
+            const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const std::int64_t year_of_era = y - era * 400;
+            const std::int64_t day_of_year = (153 * (month > 2U ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            return era * 146097 + year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year - 719468;
+        }
+
+        /// Seconds since 1970-01-01T00:00:00Z, a missing offset taken as UTC.
+        std::int64_t seconds() const noexcept
+        {
+            return days() * 86400 + hour * 3600 + minute * 60 + second - (has_offset ? offset * 60 : 0);
+        }
+    };
+
+    namespace xpar_detail
+    {
+        template <typename _Char>
+        inline bool is_value_space(const _Char c) noexcept
+        {
+            return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+        }
+
+        template <typename _Char>
+        inline void trim(const _Char*& text, const _Char*& text_end) noexcept
+        {
+            while ((text != text_end) && is_value_space(*text))
+                ++text;
+            while ((text != text_end) && is_value_space(text_end[-1]))
+                --text_end;
+        }
+
+        template <typename _Char>
+        inline bool is_digit(const _Char c) noexcept
+        {
+            return (c >= '0') && (c <= '9');
+        }
+
+        /// Reads up to 19 digits, eight at a time for char on little endian targets (SWAR); returns the first non digit.
+        template <typename _Char>
+        inline const _Char* read_digits(const _Char* text, const _Char* text_end, std::uint64_t& value, int& count) noexcept
+        {
+            for (; (text != text_end) && is_digit(*text) && (count < 19); ++text, ++count)
+                value = value * 10U + static_cast<std::uint64_t>(*text - '0');
+            return text;
+        }
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        inline const char* read_digits(const char* text, const char* text_end, std::uint64_t& value, int& count) noexcept
+        {
+            while ((text_end - text >= 8) && (count <= 11))
+            {
+                std::uint64_t block;
+                std::memcpy(&block, text, sizeof(block));
+                if ((((block & 0xF0F0F0F0F0F0F0F0U) | (((block + 0x0606060606060606U) & 0xF0F0F0F0F0F0F0F0U) >> 4)) !=
+                     0x3333333333333333U))
+                    break;
+
+                // pairs, quads, then the eight digits at once
+                block -= 0x3030303030303030U;
+                block = (block * 10U) + (block >> 8);
+                block = (((block & 0x000000FF000000FFU) * (100U + (1000000ULL << 32))) +
+                         (((block >> 16) & 0x000000FF000000FFU) * (1U + (10000ULL << 32)))) >>
+                        32;
+                value = value * 100000000U + (block & 0xFFFFFFFFU);
+                count += 8;
+                text += 8;
+            }
+
+            for (; (text != text_end) && is_digit(*text) && (count < 19); ++text, ++count)
+                value = value * 10U + static_cast<std::uint64_t>(*text - '0');
+            return text;
+        }
+#endif
+
+        /// Correctly rounded conversion of a decimal text the fast path can't take, with '.' whatever the C locale. Only a text
+        /// longer than the local buffer is copied to the heap. A value overflowing to infinity or underflowing to zero is out of range,
+        /// a subnormal one is kept.
+        template <typename _Char>
+        bool parse_double_slow(const _Char* text, const _Char* text_end, double& value)
+        {
+            char local[128];
+            const std::size_t size = text_end - text;
+            std::string heap(size < sizeof(local) ? 0U : size, '\0');
+            char* const copy = size < sizeof(local) ? local : &heap[0];
+            const char point = *std::localeconv()->decimal_point;
+            for (std::size_t i = 0U; i != size; ++i)
+            {
+                if (static_cast<std::uint32_t>(text[i]) > 127U)
+                    return false;
+                copy[i] = (text[i] == '.') ? point : static_cast<char>(text[i]);
+            }
+
+            copy[size] = '\0';
+            char* end = nullptr;
+            errno = 0;
+            value = std::strtod(copy, &end);
+            return (end == copy + size) && ((errno != ERANGE) || ((value != 0.0) && !std::isinf(value)));
+        }
+    }
+
+    /// The conversions below take a value as xpar reports it, leading and trailing whitespace allowed, and return false
+    /// for anything else than the whole text in the lexical space of the type, or a number out of range.
+    template <typename _Char, typename _Integer>
+    typename std::enable_if<std::is_integral<_Integer>::value && !std::is_same<_Integer, bool>::value, bool>::type
+        xpar_parse(const _Char* text, const _Char* text_end, _Integer& value) noexcept
+    {
+        xpar_detail::trim(text, text_end);
+        const bool negative = (text != text_end) && (*text == '-');
+        if ((text != text_end) && ((*text == '-') || (*text == '+')))
+            ++text;
+        if (text == text_end)
+            return false;
+
+        while ((text_end - text > 1) && (*text == '0'))
+            ++text;
+
+        std::uint64_t magnitude = 0U;
+        int count = 0;
+        const _Char* const digits_end = xpar_detail::read_digits(text, text_end, magnitude, count);
+        if ((count == 0) || (digits_end != text_end))
+        {
+            // a 20th digit still fits an unsigned 64-bit value
+            if ((count != 19) || (text_end - digits_end != 1) || !xpar_detail::is_digit(*digits_end) ||
+                (magnitude > (std::numeric_limits<std::uint64_t>::max() - (*digits_end - '0')) / 10U))
+                return false;
+            magnitude = magnitude * 10U + static_cast<std::uint64_t>(*digits_end - '0');
+        }
+
+        // "-0" is an unsigned value too
+        using unsigned_t = typename std::make_unsigned<_Integer>::type;
+        const std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<_Integer>::max());
+        const std::uint64_t limit = !negative ? max : (std::is_signed<_Integer>::value ? max + 1U : 0U);
+        if (magnitude > limit)
+            return false;
+
+        value = negative ? static_cast<_Integer>(0U - static_cast<unsigned_t>(magnitude)) : static_cast<_Integer>(magnitude);
+        return true;
+    }
+
+    /// Decimal and scientific notation, INF, -INF and NaN. Up to 19 significant digits with a power of ten the double keeps exact
+    /// are converted by a multiplication or a division, correctly rounded (Clinger's fast path); the rest goes to strtod.
+    template <typename _Char>
+    bool xpar_parse(const _Char* text, const _Char* text_end, double& value)
+    {
+        static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        xpar_detail::trim(text, text_end);
+        const _Char* const number = text;
+        const bool negative = (text != text_end) && (*text == '-');
+        if ((text != text_end) && ((*text == '-') || (*text == '+')))
+            ++text;
+
+        const auto is = [text, text_end](const char* word)
+        { return (static_cast<std::size_t>(text_end - text) == std::strlen(word)) && std::equal(text, text_end, word); };
+        if (is("INF"))
+        {
+            value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            return true;
+        }
+
+        if ((text == number) && is("NaN"))
+        {
+            value = std::numeric_limits<double>::quiet_NaN();
+            return true;
+        }
+
+        const _Char* const start = text;
+        while ((text != text_end) && (*text == '0'))
+            ++text;
+
+        std::uint64_t mantissa = 0U;
+        int count = 0;
+        const _Char* const integer = text;
+        text = xpar_detail::read_digits(text, text_end, mantissa, count);
+        bool exact = (text == text_end) || !xpar_detail::is_digit(*text);
+        while ((text != text_end) && xpar_detail::is_digit(*text))
+            ++text;
+
+        // the digits past the 19th only raise the exponent
+        std::int64_t exponent = static_cast<std::int64_t>(text - integer) - count;
+        bool digits = text != start;
+        if ((text != text_end) && (*text == '.'))
+        {
+            const _Char* const fraction = ++text;
+            if (mantissa == 0U)
+                while ((text != text_end) && (*text == '0'))
+                    ++text;
+
+            const _Char* const significant = text;
+            if (exact)
+            {
+                const int before = count;
+                text = xpar_detail::read_digits(text, text_end, mantissa, count);
+                exponent -= (significant - fraction) + (count - before);
+                exact = (text == text_end) || !xpar_detail::is_digit(*text);
+            }
+
+            while ((text != text_end) && xpar_detail::is_digit(*text))
+                ++text;
+            if (mantissa == 0U)
+                exponent = 0;
+            digits = digits || (text != fraction);
+        }
+
+        if (!digits)
+            return false;
+
+        if ((text != text_end) && ((*text == 'e') || (*text == 'E')))
+        {
+            std::int32_t power = 0;
+            if (!xpar_parse(text + 1, text_end, power) || xpar_detail::is_value_space(text[1]))
+                return false;
+            exponent += power;
+            text = text_end;
+        }
+
+        if (text != text_end)
+            return false;
+
+        if (mantissa == 0U)
+        {
+            value = negative ? -0.0 : 0.0;
+            return true;
+        }
+
+        if (exact && (mantissa <= (std::uint64_t(1U) << 53)))
+        {
+            // an exponent above 22 is fine when the mantissa times the excess still fits the 53 bits
+            for (; (exponent > 22) && (mantissa <= (std::uint64_t(1U) << 53) / 10U); --exponent)
+                mantissa *= 10U;
+
+            if ((exponent >= -22) && (exponent <= 22) && (mantissa <= (std::uint64_t(1U) << 53)))
+            {
+                const double result = static_cast<double>(mantissa);
+                value = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+                value = negative ? -value : value;
+                return true;
+            }
+        }
+
+        return xpar_detail::parse_double_slow(number, text_end, value);
+    }
+
+    template <typename _Char>
+    bool xpar_parse(const _Char* text, const _Char* text_end, float& value)
+    {
+        double result;
+        if (!xpar_parse(text, text_end, result))
+            return false;
+
+        value = static_cast<float>(result);
+        return true;
+    }
+
+    /// true, false, 1 or 0.
+    template <typename _Char>
+    bool xpar_parse(const _Char* text, const _Char* text_end, bool& value) noexcept
+    {
+        static const char true_text[] = "true";
+        static const char false_text[] = "false";
+        xpar_detail::trim(text, text_end);
+        const std::size_t size = text_end - text;
+        if ((size == 1U) && ((*text == '1') || (*text == '0')))
+            value = *text == '1';
+        else if ((size == 4U) && std::equal(text, text_end, true_text))
+            value = true;
+        else if ((size == 5U) && std::equal(text, text_end, false_text))
+            value = false;
+        else
+            return false;
+
+        return true;
+    }
+
+    /// yyyy-mm-dd, optionally followed by Thh:mm:ss with up to nine fraction digits, then by Z or +hh:mm / -hh:mm.
+    template <typename _Char>
+    bool xpar_parse(const _Char* text, const _Char* text_end, xpar_date_time& value) noexcept
+    {
+        const auto number = [&text, text_end](const int digits, auto& result)
+        {
+            int digits_value = 0;
+            for (int i = 0; i != digits; ++i, ++text)
+            {
+                if ((text == text_end) || !xpar_detail::is_digit(*text))
+                    return false;
+                digits_value = digits_value * 10 + (*text - '0');
+            }
+
+            result = static_cast<typename std::remove_reference<decltype(result)>::type>(digits_value);
+            return true;
+        };
+
+        const auto separator = [&text, text_end](const char c) { return (text != text_end) && (*text++ == c); };
+
+        xpar_detail::trim(text, text_end);
+        value = {};
+        if (!number(4, value.year) || !separator('-') || !number(2, value.month) || !separator('-') || !number(2, value.day))
+            return false;
+
+        static const std::uint8_t month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        const bool leap = ((value.year % 4) == 0) && (((value.year % 100) != 0) || ((value.year % 400) == 0));
+        if ((value.month < 1U) || (value.month > 12U) || (value.day < 1U) ||
+            (value.day > month_days[value.month - 1U] + ((value.month == 2U) && leap ? 1U : 0U)))
+            return false;
+
+        if ((text != text_end) && (*text == 'T'))
+        {
+            ++text;
+            value.has_time = true;
+            if (!number(2, value.hour) || !separator(':') || !number(2, value.minute) || !separator(':') || !number(2, value.second) ||
+                (value.hour > 23U) || (value.minute > 59U) || (value.second > 59U))
+                return false;
+
+            if ((text != text_end) && (*text == '.'))
+            {
+                std::uint32_t scale = 100000000U;
+                if ((++text == text_end) || !xpar_detail::is_digit(*text))
+                    return false;
+                for (; (text != text_end) && xpar_detail::is_digit(*text); ++text, scale /= 10U)
+                    value.nanosecond += static_cast<std::uint32_t>(*text - '0') * scale;
+            }
+        }
+
+        if ((text != text_end) && (*text == 'Z'))
+        {
+            ++text;
+            value.has_offset = true;
+        }
+        else if ((text != text_end) && ((*text == '+') || (*text == '-')))
+        {
+            const bool west = *text++ == '-';
+            std::uint8_t hours = 0U;
+            std::uint8_t minutes = 0U;
+            if (!number(2, hours) || !separator(':') || !number(2, minutes) || (hours > 14U) || (minutes > 59U))
+                return false;
+
+            value.has_offset = true;
+            value.offset = static_cast<std::int16_t>((west ? -1 : 1) * (hours * 60 + minutes));
+        }
+
+        return text == text_end;
+    }
+
+    /// The text as it is.
+    template <typename _Char>
+    bool xpar_parse(const _Char* text, const _Char* text_end, std::basic_string<_Char>& value)
+    {
+        value.assign(text, text_end);
+        return true;
+    }
+
+    /// Collects a value reported in pieces, on_data and on_cdata give a text split by the buffers that way; the last piece may be
+    /// reported as partial too, the next element or end tag ends the text then. A value reported whole is better converted in place;
+    /// the pieces beyond the capacity are dropped and make overflow() true.
+    template <typename _Char, std::size_t _Capacity = 64U>
+    class xpar_value_buffer
+    {
+    public:
+        void append(const _Char* text, const _Char* text_end) noexcept
+        {
+            const std::size_t size = std::min<std::size_t>(text_end - text, _Capacity - size_);
+            std::copy(text, text + size, data_ + size_);
+            size_ += size;
+            overflow_ = overflow_ || (text + size != text_end);
+        }
+
+        void clear() noexcept
+        {
+            size_ = 0U;
+            overflow_ = false;
+        }
+
+        const _Char* data() const noexcept { return data_; }
+        const _Char* data_end() const noexcept { return data_ + size_; }
+        bool empty() const noexcept { return size_ == 0U; }
+        bool overflow() const noexcept { return overflow_; }
+
+        template <typename _Value>
+        bool parse(_Value& value) const
+        {
+            return !overflow_ && xpar_parse(data_, data_ + size_, value);
+        }
+
+    private:
+        _Char data_[_Capacity];
+        std::size_t size_ {};
+        bool overflow_ {};
+    };
+}
@@ -0,0 +1,1775 @@
+#include "tools.hpp"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <xpar.hpp>
+#include <xpar_bind.hpp>
+#include <xpar_columns.hpp>
+#include <xpar_dfa.hpp>
+#include <xpar_dom.hpp>
+#include <xpar_dom_index.hpp>
+#include <xpar_encoding.hpp>
+#include <xpar_filter.hpp>
+#include <xpar_index.hpp>
+#include <xpar_namespace.hpp>
+#include <xpar_path.hpp>
+#include <xpar_query.hpp>
+#include <xpar_schema.hpp>
+#include <xpar_value.hpp>
+
+namespace xpar_testing
+{
+    struct xpar_full_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16
+        };
+    };
+
+    // names longer than 255 characters
+    struct xpar_long_name_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 300,
+            max_value_length = 512,
+            max_stack_size = 4
+        };
+    };
+
+    struct xpar_trusted_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            track_position = 0,
+            error_recovery = 0,
+            report_comments = 0,
+            doctype = 1,
+            check_limits = 0
+        };
+    };
+
+    struct xpar_computed_goto_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            computed_goto = 1
+        };
+    };
+
+    struct xpar_start_tag_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            max_attributes = 16
+        };
+    };
+
+    struct xpar_start_tag_recovering_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 1,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            max_attributes = 1
+        };
+    };
+
+    struct xpar_lazy_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            lazy_attributes = 1
+        };
+    };
+
+    struct xpar_lazy_recovering_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 1,
+            max_name_length = 32,
+            max_value_length = 8,
+            max_stack_size = 16,
+            lazy_attributes = 1
+        };
+    };
+
+    struct xpar_decoding_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            decode_references = 1
+        };
+    };
+
+    struct xpar_recovering_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 1,
+            max_name_length = 8,
+            max_value_length = 512,
+            max_stack_size = 4
+        };
+    };
+
+    struct xpar_trimming_config
+    {
+        using char_t = char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            decode_references = 1,
+            trim_text = 1
+        };
+    };
+
+    template <typename _Config, template <typename, typename> class _Parser = stdext::xpar>
+    class counting_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = _Parser<counting_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) {}
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_attribute(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++attribute_count; }
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) {}
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    /// counting_observer without on_attribute_value and on_comment: the values are only scanned for their closing quote.
+    template <typename _Config>
+    class attribute_names_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<attribute_names_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_attribute(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++attribute_count; }
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    using names_traits_t = stdext::xpar_observer_traits<attribute_names_observer<xpar_full_config>,
+                                                        attribute_names_observer<xpar_full_config>::xpar_t>;
+    static_assert(names_traits_t::on_attribute::value && !names_traits_t::on_attribute_value::value, "on_attribute_value detected");
+    static_assert(!names_traits_t::on_element_begin::value && !names_traits_t::on_comment::value, "missing callbacks detected");
+    using counting_traits_t = stdext::xpar_observer_traits<counting_observer<xpar_full_config>, counting_observer<xpar_full_config>::xpar_t>;
+    static_assert(counting_traits_t::on_attribute_value::value && counting_traits_t::on_comment::value, "callbacks detected");
+
+    template <typename _Config>
+    class start_tag_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<start_tag_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using attribute_t = typename xpar_t::attribute_t;
+
+        void on_start_tag(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/, const attribute_t* attributes,
+                          const attribute_t* attributes_end)
+        {
+            attribute_count += attributes_end - attributes;
+        }
+
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    /// Counts the attributes of the lazy start tags by iterating them.
+    template <typename _Config>
+    class lazy_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<lazy_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/,
+                              const stdext::xpar_attributes<char_t>& attributes)
+        {
+            attribute_count += std::distance(attributes.begin(), attributes.end());
+        }
+
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    template <typename _Config>
+    class selecting_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<selecting_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        static constexpr bool wanted_attribute(const xpar_t& /*parser*/, const std::uint32_t element,
+                                               const std::uint32_t attribute) noexcept
+        {
+            switch (attribute)
+            {
+                case stdext::xpar_hash("VALUE"):
+                    return true;
+                case stdext::xpar_hash("name"):
+                    return element == stdext::xpar_hash("var");
+                default:
+                    return false;
+            }
+        }
+
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_attribute(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++attribute_count; }
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) {}
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    template <typename _Config>
+    class path_observer: public stdext::counting_observer
+    {
+    public:
+        using filter_t = stdext::xpar_path_filter<path_observer, _Config>;
+        using char_t = typename filter_t::char_t;
+
+        class xpar_t: public filter_t
+        {
+        public:
+            xpar_t(path_observer* const observer): filter_t(observer)
+            {
+                static const char* const paths[] = {"/codeBook/dataDscr/var/@name", "//labl", "//catgry/catValu"};
+                for (const char* path: paths)
+                    this->subscribe(path, path + std::strlen(path));
+            }
+        };
+
+        void on_element_begin(filter_t& /*filter*/, const std::uint32_t /*path*/, const char_t* /*name*/, const char_t* /*name_end*/) {}
+        void on_element_end(filter_t& /*filter*/, const std::uint32_t /*path*/, const char_t* /*name*/, const char_t* /*name_end*/)
+        {
+            ++element_count;
+        }
+
+        void on_attribute(filter_t& /*filter*/, const std::uint32_t /*path*/, const char_t* /*name*/, const char_t* /*name_end*/,
+                          const char_t* /*value*/, const char_t* /*value_end*/)
+        {
+            ++attribute_count;
+        }
+
+        void on_data(filter_t& /*filter*/, const std::uint32_t /*path*/, const char_t* /*text*/, const char_t* /*text_end*/,
+                     const bool /*partial*/)
+        {
+            ++data_count;
+        }
+
+        void on_error(filter_t& filter, bool& /*try_continue*/)
+        {
+            std::cout << filter.parser().line() << ':' << filter.parser().column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    template <typename _Config>
+    class query_observer: public stdext::counting_observer
+    {
+    public:
+        using query_set_t = stdext::xpar_query_set<query_observer, _Config>;
+
+        class xpar_t: public query_set_t
+        {
+        public:
+            xpar_t(query_observer* const observer): query_set_t(observer)
+            {
+                static const char* const queries[] = {"/codeBook/dataDscr/var[@name='CASEID']/labl", "//var[@format='char']//catValu",
+                                                      "//labl[@level='variable']", "/codeBook/stdyDscr//titl", "//*[@ID='v960001']",
+                                                      "//catgry[@missing='Y']", "/codeBook/fileDscr/*/fileStrc[@type]", "//nothere"};
+                for (const char* query: queries)
+                    this->add(query, query + std::strlen(query));
+            }
+        };
+
+        void on_match(query_set_t& /*queries*/, const std::uint32_t /*query*/) { ++element_count; }
+        void on_error(query_set_t& queries, bool& /*try_continue*/)
+        {
+            std::cout << queries.parser().line() << ':' << queries.parser().column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    template <typename _Config>
+    class dom_observer: public stdext::counting_observer
+    {
+    public:
+        using dom_t = stdext::xpar_dom<_Config>;
+        using char_t = typename dom_t::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(dom_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                dom_.reserve(buffer, buffer_size);
+                builder_.build(buffer, buffer_size);
+                for (std::size_t node = 0U; node != dom_.size(); ++node)
+                    switch (dom_.kind(static_cast<typename dom_t::node_t>(node)))
+                    {
+                        case dom_t::element:
+                            ++observer_->element_count;
+                            break;
+                        case dom_t::attribute:
+                            ++observer_->attribute_count;
+                            break;
+                        case dom_t::text:
+                        case dom_t::cdata:
+                            ++observer_->data_count;
+                            break;
+                        case dom_t::comment:
+                            ++observer_->comment_count;
+                            break;
+                        default:
+                            break;
+                    }
+
+                if (builder_.parser().error() != decltype(builder_.parser().error()) {})
+                    ++observer_->error_count;
+            }
+
+        private:
+            dom_observer* observer_;
+            dom_t dom_ {};
+            stdext::xpar_dom_builder<_Config> builder_ {&dom_};
+        };
+    };
+
+    const stdext::xpar_schema<char>& test_schema()
+    {
+        using stdext::xpar_simple_type;
+        static const struct
+        {
+            const char* name;
+            const char* content;
+            xpar_simple_type text;
+        } elements[] = {
+            {"data", "(programmer*)", xpar_simple_type::string},
+            {"programmer", "(name, language, birth, country, profession, website)", xpar_simple_type::string},
+            {"name", "(#PCDATA)", xpar_simple_type::string},
+            {"language", "(#PCDATA)", xpar_simple_type::string},
+            {"birth", "(#PCDATA)", xpar_simple_type::string},
+            {"country", "(#PCDATA)", xpar_simple_type::string},
+            {"profession", "(#PCDATA)", xpar_simple_type::string},
+            {"website", "(#PCDATA)", xpar_simple_type::string},
+            {"codeBook", "(stdyDscr, fileDscr, dataDscr)", xpar_simple_type::string},
+            {"stdyDscr", "(citation, stdyInfo?)", xpar_simple_type::string},
+            {"citation", "(titlStmt, prodStmt?)", xpar_simple_type::string},
+            {"titlStmt", "(titl)", xpar_simple_type::string},
+            {"titl", "(#PCDATA)", xpar_simple_type::string},
+            {"prodStmt", "(producer*, prodDate?)", xpar_simple_type::string},
+            {"producer", "(#PCDATA)", xpar_simple_type::string},
+            {"prodDate", "(#PCDATA)", xpar_simple_type::string},
+            {"stdyInfo", "(sumDscr)", xpar_simple_type::string},
+            {"sumDscr", "(dataKind*)", xpar_simple_type::string},
+            {"dataKind", "(#PCDATA)", xpar_simple_type::string},
+            {"fileDscr", "(fileTxt)", xpar_simple_type::string},
+            {"fileTxt", "(fileStrc, dimensns)", xpar_simple_type::string},
+            {"fileStrc", "EMPTY", xpar_simple_type::string},
+            {"dimensns", "(caseQnty, logRecL, recPrCas)", xpar_simple_type::string},
+            {"caseQnty", "(#PCDATA)", xpar_simple_type::integer},
+            {"logRecL", "(#PCDATA)", xpar_simple_type::integer},
+            {"recPrCas", "(#PCDATA)", xpar_simple_type::integer},
+            {"dataDscr", "(var+)", xpar_simple_type::string},
+            {"var", "(location, labl, qstn?, (valrng | invalrng)*, catgryGrp*)", xpar_simple_type::string},
+            {"location", "EMPTY", xpar_simple_type::string},
+            {"labl", "(#PCDATA)", xpar_simple_type::string},
+            {"qstn", "(qstnLit)", xpar_simple_type::string},
+            {"qstnLit", "(#PCDATA)", xpar_simple_type::string},
+            {"catgryGrp", "(catgry+)", xpar_simple_type::string},
+            {"catgry", "(catValu, txt?)", xpar_simple_type::string},
+            {"catValu", "(#PCDATA)", xpar_simple_type::decimal},
+            {"txt", "(#PCDATA)", xpar_simple_type::string},
+            {"valrng", "(item+)", xpar_simple_type::string},
+            {"invalrng", "(item+)", xpar_simple_type::string},
+            {"item", "EMPTY", xpar_simple_type::string},
+        };
+
+        static const struct
+        {
+            const char* element;
+            const char* name;
+            bool required;
+            xpar_simple_type type;
+        } attributes[] = {
+            {"programmer", "id", true, xpar_simple_type::integer}, {"fileStrc", "type", true, xpar_simple_type::string},
+            {"var", "ID", true, xpar_simple_type::string},         {"var", "name", true, xpar_simple_type::string},
+            {"var", "dcml", false, xpar_simple_type::integer},     {"var", "format", false, xpar_simple_type::string},
+            {"location", "StartPos", true, xpar_simple_type::integer}, {"location", "width", true, xpar_simple_type::integer},
+            {"location", "cardNo", false, xpar_simple_type::integer},  {"labl", "level", false, xpar_simple_type::string},
+            {"catgry", "missing", false, xpar_simple_type::string},    {"txt", "level", false, xpar_simple_type::string},
+            {"valrng", "relation", false, xpar_simple_type::string},   {"invalrng", "relation", false, xpar_simple_type::string},
+            {"item", "VALUE", true, xpar_simple_type::decimal},        {"item", "UNITS", false, xpar_simple_type::string},
+        };
+
+        static const stdext::xpar_schema<char> schema = []()
+        {
+            stdext::xpar_schema<char> result;
+            for (const auto& element: elements)
+                result.element(element.name, element.content, element.text);
+            for (const auto& attribute: attributes)
+                result.attribute(attribute.element, attribute.name, attribute.required, attribute.type);
+            result.compile();
+            return result;
+        }();
+
+        return schema;
+    }
+
+    /// Counts the events and validates them inline; a document is over with the end of its root, error_count is set there.
+    template <typename _Config>
+    class validating_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<validating_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void clear()
+        {
+            stdext::counting_observer::clear();
+            validator_.reset();
+        }
+
+        void on_element_begin(xpar_t& parser, const char_t* name, const char_t* name_end)
+        {
+            validator_.on_element_begin(parser, name, name_end);
+        }
+
+        void on_element_end(xpar_t& parser, const char_t* name, const char_t* name_end)
+        {
+            ++element_count;
+            validator_.on_element_end(parser, name, name_end);
+            error_count = validator_.error_count();
+        }
+
+        void on_attribute(xpar_t& parser, const char_t* name, const char_t* name_end)
+        {
+            ++attribute_count;
+            validator_.on_attribute(parser, name, name_end);
+        }
+
+        void on_attribute_value(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            validator_.on_attribute_value(parser, text, text_end, partial);
+        }
+
+        void on_start_tag_end(xpar_t& parser, const bool empty) { validator_.on_start_tag_end(parser, empty); }
+        void on_data(xpar_t& parser, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            ++data_count;
+            validator_.on_data(parser, text, text_end, partial);
+        }
+
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+
+    private:
+        stdext::xpar_validator<char_t> validator_ {&test_schema()};
+    };
+
+    /// Converts every attribute value and text to a number; attribute_count and data_count count the numeric ones.
+    template <typename _Config>
+    class typed_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<typed_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { data_count += flush(); }
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/)
+        {
+            ++element_count;
+            data_count += flush();
+        }
+
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            attribute_count += convert(text, text_end, partial);
+        }
+
+        void on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            data_count += convert(text, text_end, partial);
+        }
+
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+
+    private:
+        std::size_t convert(const char_t* text, const char_t* text_end, const bool partial)
+        {
+            double number;
+            if (!partial && value_.empty())
+                return stdext::xpar_parse(text, text_end, number) ? 1U : 0U;
+
+            value_.append(text, text_end);
+            return partial ? 0U : flush();
+        }
+
+        // a text may end with a partial piece, the next event ends it then
+        std::size_t flush()
+        {
+            double number;
+            const bool numeric = !value_.empty() && value_.parse(number);
+            value_.clear();
+            return numeric ? 1U : 0U;
+        }
+
+        stdext::xpar_value_buffer<char_t> value_ {};
+    };
+
+    struct test_variable
+    {
+        std::string name;
+        std::uint32_t width;
+        std::string label;
+        std::vector<std::int32_t> values;
+    };
+
+    bool operator==(const test_variable& left, const test_variable& right)
+    {
+        return (left.name == right.name) && (left.width == right.width) && (left.label == right.label) && (left.values == right.values);
+    }
+
+    const auto& test_binding()
+    {
+        using stdext::xpar_member;
+        static const auto binding = stdext::xpar_bind<test_variable>(
+            "/codeBook/dataDscr/var", xpar_member("@name", &test_variable::name), xpar_member("location/@width", &test_variable::width),
+            xpar_member("labl", &test_variable::label), xpar_member("catgryGrp/catgry/catValu", &test_variable::values));
+        return binding;
+    }
+
+    /// Binds the variables of nes96; element_count counts the records, attribute_count the widths and data_count the values.
+    template <typename _Config>
+    class binding_observer: public stdext::counting_observer
+    {
+    public:
+        using binder_t = stdext::xpar_binder<std::decay_t<decltype(test_binding())>, _Config>;
+        using char_t = typename binder_t::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(binding_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                binder_(buffer, buffer_size);
+                for (const auto& variable: variables_)
+                {
+                    ++observer_->element_count;
+                    observer_->attribute_count += (variable.width != 0U) ? 1U : 0U;
+                    observer_->data_count += variable.values.size();
+                }
+
+                if (binder_.parser().error() != decltype(binder_.parser().error()) {})
+                    ++observer_->error_count;
+            }
+
+        private:
+            binding_observer* observer_;
+            std::vector<test_variable> variables_ {};
+            binder_t binder_ {test_binding(), &variables_};
+        };
+    };
+
+    /// Extracts columns from the variables of nes96; element_count counts the rows, attribute_count the widths and data_count the labels.
+    template <typename _Config>
+    class columns_observer: public stdext::counting_observer
+    {
+    public:
+        using extractor_t = stdext::xpar_column_extractor<_Config>;
+        using char_t = typename extractor_t::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(columns_observer* const observer): observer_(observer)
+            {
+                using stdext::xpar_column_type;
+                static const char record[] = "/codeBook/dataDscr/var";
+                static const std::pair<const char*, xpar_column_type> columns[] = {{"@name", xpar_column_type::utf8},
+                                                                                   {"location/@width", xpar_column_type::int32},
+                                                                                   {"labl", xpar_column_type::utf8},
+                                                                                   {"catgryGrp/catgry/catValu", xpar_column_type::int64}};
+                extractor_.set_record(record, record + sizeof(record) - 1U);
+                for (const auto& column: columns)
+                    extractor_.add_column(column.first, column.first + std::strlen(column.first), column.second);
+            }
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                extractor_(buffer, buffer_size);
+                observer_->element_count += extractor_.rows();
+                observer_->attribute_count += extractor_.column(1U).length() - extractor_.column(1U).null_count();
+                observer_->data_count += extractor_.column(2U).length() - extractor_.column(2U).null_count();
+                if (extractor_.parser().error() != decltype(extractor_.parser().error()) {})
+                    ++observer_->error_count;
+            }
+
+        private:
+            columns_observer* observer_;
+            extractor_t extractor_ {};
+        };
+    };
+
+    /// Builds and indexes the document, then counts the elements, attributes and texts a few queries select.
+    template <typename _Config>
+    class index_observer: public stdext::counting_observer
+    {
+    public:
+        using dom_t = stdext::xpar_dom<_Config>;
+        using index_t = stdext::xpar_dom_index<_Config>;
+        using char_t = typename dom_t::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(index_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                static const char* const queries[] = {"/codeBook/dataDscr/var[@format='char']/labl", "//catgryGrp/catgry[2]/catValu",
+                                                      "//var[@ID='v960010']//catValu", "//location/@width", "/codeBook/stdyDscr//titl"};
+                dom_.reserve(buffer, buffer_size);
+                builder_.build(buffer, buffer_size);
+                index_.build(dom_);
+                for (const char* query: queries)
+                {
+                    if (!index_.select(query, query + std::strlen(query), nodes_))
+                        ++observer_->error_count;
+                    for (const auto node: nodes_)
+                        if (dom_.kind(node) == dom_t::attribute)
+                            ++observer_->attribute_count;
+                        else
+                            ++observer_->element_count;
+                }
+
+                if (builder_.parser().error() != decltype(builder_.parser().error()) {})
+                    ++observer_->error_count;
+            }
+
+        private:
+            index_observer* observer_;
+            dom_t dom_ {};
+            stdext::xpar_dom_builder<_Config> builder_ {&dom_};
+            index_t index_ {};
+            typename index_t::nodes_t nodes_ {};
+        };
+    };
+
+    /// Builds the offset index of every element; element_count counts the entries.
+    template <typename _Config>
+    class index_builder_observer: public stdext::counting_observer
+    {
+    public:
+        using builder_t = stdext::xpar_index_builder<_Config>;
+        using char_t = typename builder_t::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(index_builder_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                parser_(buffer, buffer_size);
+                observer_->element_count += builder_.entries().size();
+                if (parser_.error() != decltype(parser_.error()) {})
+                    ++observer_->error_count;
+            }
+
+        private:
+            index_builder_observer* observer_;
+            builder_t builder_ {};
+            typename builder_t::xpar_t parser_ {&builder_};
+        };
+    };
+
+    /// Counts the events of the namespace adapter, the same as counting_observer.
+    template <typename _Config>
+    class namespace_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar_namespace<namespace_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const std::uint32_t /*uri*/, const char_t* /*name*/, const char_t* /*name_end*/) {}
+        void on_element_end(xpar_t& /*parser*/, const std::uint32_t /*uri*/, const char_t* /*name*/, const char_t* /*name_end*/)
+        {
+            ++element_count;
+        }
+
+        void on_attribute(xpar_t& /*parser*/, const std::uint32_t /*uri*/, const char_t* /*name*/, const char_t* /*name_end*/)
+        {
+            ++attribute_count;
+        }
+
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) {}
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+        void on_error(xpar_t& /*parser*/, bool& /*try_continue*/) { ++error_count; }
+    };
+
+    /// Drops the labl elements and replaces the txt ones with an empty element.
+    template <typename _Config>
+    struct filtering_rules
+    {
+        using char_t = char;
+
+        template <typename _Filter>
+        void on_element_begin(_Filter& filter, const char_t* name, const char_t* name_end, stdext::xpar_filter_action& action)
+        {
+            static const char_t replacement[] = "<txt/>";
+            if (std::equal(name, name_end, "labl", "labl" + 4))
+                action = stdext::xpar_filter_action::drop;
+            else if (std::equal(name, name_end, "txt", "txt" + 3))
+            {
+                action = stdext::xpar_filter_action::replace;
+                filter.set_replacement(replacement, replacement + sizeof(replacement) - 1U);
+            }
+        }
+
+        template <typename _Filter>
+        void on_error(_Filter& /*filter*/, bool& /*try_continue*/)
+        {
+            ++error_count;
+        }
+
+        std::size_t error_count {};
+    };
+
+    struct string_sink
+    {
+        template <typename _Slice>
+        void write(const _Slice* slices, const std::size_t count)
+        {
+            for (std::size_t i = 0U; i != count; ++i)
+                result.append(slices[i].data, slices[i].size);
+        }
+
+        std::string result {};
+    };
+
+    constexpr std::size_t filter_chunk_size = 256U;
+
+    /// Filters the input in small chunks; element_count counts the output bytes.
+    template <typename _Config>
+    class filter_observer: public stdext::counting_observer
+    {
+    public:
+        using char_t = typename _Config::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(filter_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                sink_.result.reserve(buffer_size);
+                for (std::size_t i = 0U; i < buffer_size; i += filter_chunk_size)
+                    filter_(buffer + i, std::min(filter_chunk_size, buffer_size - i));
+                filter_.finish();
+                observer_->element_count += sink_.result.size();
+                observer_->error_count += rules_.error_count;
+            }
+
+        private:
+            filter_observer* observer_;
+            filtering_rules<_Config> rules_ {};
+            string_sink sink_ {};
+            stdext::xpar_filter<filtering_rules<_Config>, string_sink, _Config> filter_ {&rules_, &sink_};
+        };
+    };
+
+    /// The baseline of the filter: the input copied in the same chunks.
+    template <typename _Config>
+    class copy_observer: public stdext::counting_observer
+    {
+    public:
+        using char_t = typename _Config::char_t;
+
+        class xpar_t
+        {
+        public:
+            xpar_t(copy_observer* const observer): observer_(observer) {}
+
+            void operator()(const char_t* buffer, const std::size_t buffer_size)
+            {
+                result_.reserve(buffer_size);
+                for (std::size_t i = 0U; i < buffer_size; i += filter_chunk_size)
+                    result_.append(buffer + i, std::min(filter_chunk_size, buffer_size - i));
+                observer_->element_count += result_.size();
+            }
+
+        private:
+            copy_observer* observer_;
+            std::string result_ {};
+        };
+    };
+
+    /// Records the events as text: <name, @name=value, [text], {cdata}, /name, !error; the pieces of a text are joined.
+    template <typename _Config, template <typename, typename> class _Parser = stdext::xpar>
+    class transcript_observer
+    {
+    public:
+        using xpar_t = _Parser<transcript_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const char_t* name, const char_t* name_end) { event('<', name, name_end); }
+        void on_element_end(xpar_t& /*parser*/, const char_t* name, const char_t* name_end) { event('/', name, name_end); }
+        void on_attribute(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+        {
+            event('@', name, name_end);
+            result += '=';
+        }
+
+        // the start tags of lazy_attributes
+        void on_element_begin(xpar_t& /*parser*/, const char_t* name, const char_t* name_end,
+                              const stdext::xpar_attributes<char_t>& attributes)
+        {
+            event('<', name, name_end);
+            for (const auto& attribute: attributes)
+            {
+                event('@', attribute.name, attribute.name_end);
+                result += '=';
+                result.append(attribute.value, attribute.value_end);
+            }
+        }
+
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool /*partial*/)
+        {
+            result.append(text, text_end);
+        }
+
+        void on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            piece('[', ']', text, text_end, partial);
+        }
+
+        void on_cdata(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            piece('{', '}', text, text_end, partial);
+        }
+
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            flush();
+            result += '!';
+            result += std::to_string(static_cast<int>(parser.error()));
+        }
+
+        std::string str()
+        {
+            flush();
+            return result;
+        }
+
+        std::string result {};
+
+    private:
+        void event(const char kind, const char_t* name, const char_t* name_end)
+        {
+            flush();
+            result += kind;
+            result.append(name, name_end);
+        }
+
+        // a text may end with a partial piece, the next event ends it then
+        void piece(const char open, const char close, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            if (close_ != close)
+            {
+                flush();
+                result += open;
+                close_ = close;
+            }
+
+            result.append(text, text_end);
+            if (!partial)
+                flush();
+        }
+
+        void flush()
+        {
+            if (close_)
+                result += close_;
+            close_ = {};
+        }
+
+        char close_ {};
+    };
+
+    /// Records the events of the namespace adapter as transcript_observer does, the names as uri id:local name.
+    template <typename _Config>
+    class namespace_transcript_observer
+    {
+    public:
+        using xpar_t = stdext::xpar_namespace<namespace_transcript_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const std::uint32_t uri, const char_t* name, const char_t* name_end)
+        {
+            event('<', uri, name, name_end);
+        }
+
+        void on_element_end(xpar_t& /*parser*/, const std::uint32_t uri, const char_t* name, const char_t* name_end)
+        {
+            event('/', uri, name, name_end);
+        }
+
+        void on_attribute(xpar_t& /*parser*/, const std::uint32_t uri, const char_t* name, const char_t* name_end)
+        {
+            event('@', uri, name, name_end);
+            result += '=';
+        }
+
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool /*partial*/)
+        {
+            result.append(text, text_end);
+        }
+
+        void on_data(xpar_t& /*parser*/, const char_t* text, const char_t* text_end, const bool partial)
+        {
+            if (!text_)
+                result += '[';
+            text_ = partial;
+            result.append(text, text_end);
+            if (!partial)
+                result += ']';
+        }
+
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            result += '!';
+            result += std::to_string(static_cast<int>(parser.parser().error()));
+        }
+
+        std::string str() const { return result; }
+
+        std::string result {};
+
+    private:
+        void event(const char kind, const std::uint32_t uri, const char_t* name, const char_t* name_end)
+        {
+            if (text_)
+                result += ']';
+            text_ = false;
+            result += kind;
+            result += std::to_string(uri);
+            result += ':';
+            result.append(name, name_end);
+        }
+
+        bool text_ {};
+    };
+
+    /// Records the start tags collected by on_start_tag as <name@name=value..., then the errors as !error.
+    template <typename _Config>
+    class start_tag_transcript_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<start_tag_transcript_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+        using attribute_t = typename xpar_t::attribute_t;
+
+        void on_start_tag(xpar_t& /*parser*/, const char_t* name, const char_t* name_end, const attribute_t* attributes,
+                          const attribute_t* attributes_end)
+        {
+            result += '<';
+            result.append(name, name_end);
+            for (auto attribute = attributes; attribute != attributes_end; ++attribute)
+            {
+                result += '@';
+                result.append(attribute->name, attribute->name_end);
+                result += '=';
+                result.append(attribute->value, attribute->value_end);
+            }
+        }
+
+        void on_element_end(xpar_t& /*parser*/, const char_t* name, const char_t* name_end)
+        {
+            result += '/';
+            result.append(name, name_end);
+        }
+
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            result += '!';
+            result += std::to_string(static_cast<int>(parser.error()));
+        }
+
+        std::string str() const { return result; }
+
+        std::string result {};
+    };
+
+    std::size_t failure_count {};
+
+    void check(const bool condition, const std::string& what)
+    {
+        if (!condition)
+        {
+            ++failure_count;
+            std::cout << "check failed: " << what << '\n';
+        }
+    }
+
+    template <typename _Observer>
+    std::string transcript(const std::string& xml, const std::size_t chunk_size)
+    {
+        _Observer observer;
+        typename _Observer::xpar_t parser(&observer);
+        for (std::size_t i = 0U; i < xml.size(); i += chunk_size)
+            parser(xml.data() + i, std::min(chunk_size, xml.size() - i));
+        return observer.str();
+    }
+
+    /// Checks the events of a document against the expected ones, whatever the buffer boundaries.
+    template <typename _Observer>
+    void check_transcript(const std::string& xml, const std::string& expected)
+    {
+        for (std::size_t chunk_size = 1U; chunk_size <= xml.size(); ++chunk_size)
+        {
+            const std::string result = transcript<_Observer>(xml, chunk_size);
+            check(result == expected, xml + " in chunks of " + std::to_string(chunk_size) + ": " + result + " instead of " + expected);
+        }
+    }
+
+    /// Checks that a parser restored from a checkpoint taken at each position continues with the same events.
+    template <typename _Observer>
+    void check_checkpoints(const std::string& xml)
+    {
+        using xpar_t = typename _Observer::xpar_t;
+        const std::string expected = transcript<_Observer>(xml, xml.size());
+        std::array<unsigned char, xpar_t::max_checkpoint_size> data;
+        for (std::size_t split = 0U; split <= xml.size(); ++split)
+        {
+            _Observer observer;
+            xpar_t parser(&observer);
+            parser(xml.data(), split);
+            const std::size_t size = parser.checkpoint(data.data(), data.size());
+            if (size == 0U)
+                continue;
+
+            xpar_t restored(&observer);
+            check(restored.restore(data.data(), size), xml + " restored at " + std::to_string(split));
+            restored(xml.data() + split, xml.size() - split);
+            check(observer.str() == expected, xml + " restored at " + std::to_string(split) + ": " + observer.result);
+
+            // another version or character size is rejected
+            for (const std::size_t index: {0U, 26U})
+            {
+                ++data[index];
+                check(!restored.restore(data.data(), size), xml + " restored with byte " + std::to_string(index) + " changed");
+                --data[index];
+            }
+        }
+    }
+
+    /// Builds, saves and loads the index of a document, then checks the entries against the document and seeks to some of them.
+    template <typename _Config>
+    void check_index(const std::vector<char>& xml, const std::string& name)
+    {
+        using builder_t = stdext::xpar_index_builder<_Config>;
+        builder_t builder;
+        typename builder_t::xpar_t parser(&builder);
+        for (std::size_t i = 0U; i < xml.size(); i += 4096U)
+            parser(xml.data() + i, std::min<std::size_t>(4096U, xml.size() - i));
+
+        const char* const file_path = "xpar_index_check.tmp";
+        check(builder.save(file_path), name + ": index saved");
+        const auto data = stdext::read_file(file_path);
+        std::remove(file_path);
+        const stdext::xpar_index_view<char> view(data.data(), data.size());
+        check(view.valid() && (view.size() == builder.entries().size()) && (view.size() != 0U), name + ": index loaded");
+
+        // the entries follow the document order, the lines are counted from the previous one
+        std::size_t index = 0U;
+        std::uint32_t line = 1U;
+        auto line_end = xml.begin();
+        for (const auto& entry: view)
+        {
+            const auto tag = xml.begin() + static_cast<std::ptrdiff_t>(std::min<std::uint64_t>(entry.offset, xml.size()));
+            line += static_cast<std::uint32_t>(std::count(line_end, tag, '\n'));
+            line_end = tag;
+            std::string last;
+            const bool read = view.for_each_name(entry.path, [&](const char* item, const char* item_end) { last.assign(item, item_end); });
+            const bool found = read && (entry.offset + 1U + last.size() <= xml.size()) && (xml[entry.offset] == '<') &&
+                               std::equal(last.begin(), last.end(), xml.begin() + entry.offset + 1U);
+            check(found && (entry.line == line),
+                  name + ": entry " + std::to_string(index) + " at " + std::to_string(entry.offset));
+
+            // the rest of the document parses from the entry, closing its ancestors
+            if (index++ % 257U == 0U)
+            {
+                counting_observer<_Config> observer;
+                typename counting_observer<_Config>::xpar_t resumed(&observer);
+                check(view.seek(resumed, entry), name + ": seek to entry " + std::to_string(index - 1U));
+                resumed(xml.data() + entry.offset, xml.size() - entry.offset);
+                check((resumed.error() == decltype(resumed.error()) {}) && (resumed.stack_size() == 0U),
+                      name + ": parse from entry " + std::to_string(index - 1U));
+            }
+        }
+    }
+
+    /// Checks the filter output at several chunk sizes against a plain search for the filtered elements, which do not nest.
+    void check_filter(const std::vector<char>& xml)
+    {
+        std::string expected;
+        for (auto in = xml.begin(); in != xml.end();)
+        {
+            const auto tag = std::find(in, xml.end(), '<');
+            expected.append(in, tag);
+            in = tag;
+            if (in == xml.end())
+                break;
+
+            for (const std::string name: {"labl", "txt"})
+            {
+                const std::string open = '<' + name + ' ';
+                const std::string close = "</" + name + '>';
+                if ((xml.end() - in > static_cast<std::ptrdiff_t>(open.size())) && std::equal(open.begin(), open.end(), in))
+                {
+                    in = std::search(in, xml.end(), close.begin(), close.end()) + close.size();
+                    expected += (name == "txt") ? "<txt/>" : "";
+                    break;
+                }
+            }
+
+            if ((in != xml.end()) && (*in == '<'))
+                expected += *in++;
+        }
+
+        for (const std::size_t chunk_size: {1U, 7U, 64U, 4096U, 0U})
+        {
+            filtering_rules<xpar_full_config> rules;
+            string_sink sink;
+            stdext::xpar_filter<filtering_rules<xpar_full_config>, string_sink, xpar_full_config> filter(&rules, &sink);
+            const std::size_t size = chunk_size ? chunk_size : xml.size();
+            for (std::size_t i = 0U; i < xml.size(); i += size)
+                filter(xml.data() + i, std::min(size, xml.size() - i));
+            filter.finish();
+            check((sink.result == expected) && (rules.error_count == 0U), "filter in chunks of " + std::to_string(size));
+        }
+    }
+
+    std::vector<test_variable> bind_variables(const std::vector<char>& xml, const std::size_t chunk_size)
+    {
+        std::vector<test_variable> variables;
+        stdext::xpar_binder<std::decay_t<decltype(test_binding())>, xpar_full_config> binder(test_binding(), &variables);
+        for (std::size_t i = 0U; i < xml.size(); i += chunk_size)
+            binder(xml.data() + i, std::min(chunk_size, xml.size() - i));
+        check(binder.parser().error() == decltype(binder.parser().error()) {}, "binding in chunks of " + std::to_string(chunk_size));
+        return variables;
+    }
+
+    /// Binds nes96 in chunks of several sizes, the records must not depend on the buffer boundaries.
+    void check_binding(const std::vector<char>& xml)
+    {
+        const auto expected = bind_variables(xml, xml.size());
+        std::size_t values = 0U;
+        for (const auto& variable: expected)
+            values += variable.values.size();
+        check((expected.size() == 1393U) && (values == 8844U), "binding of the nes96 variables and values");
+        for (const std::size_t chunk_size: {1U, 7U, 64U, 4096U})
+            check(bind_variables(xml, chunk_size) == expected, "bound variables in chunks of " + std::to_string(chunk_size));
+    }
+
+    /// Extracts the columns of the nes96 variables in chunks of several sizes and checks them against the bound records.
+    void check_columns(const std::vector<char>& xml)
+    {
+        using stdext::xpar_column_type;
+        const auto variables = bind_variables(xml, xml.size());
+        static const char record[] = "/codeBook/dataDscr/var";
+        static const std::pair<const char*, xpar_column_type> fields[] = {{"@name", xpar_column_type::utf8},
+                                                                          {"location/@width", xpar_column_type::int32},
+                                                                          {"labl", xpar_column_type::utf8},
+                                                                          {"catgryGrp/catgry/catValu", xpar_column_type::int64}};
+        const auto text = [](const stdext::xpar_column& column, const std::size_t row)
+        {
+            const auto data = reinterpret_cast<const char*>(column.data());
+            return std::string(data + column.offsets()[row], data + column.offsets()[row + 1U]);
+        };
+
+        for (const std::size_t chunk_size: {1U, 7U, 64U, 4096U, 0U})
+        {
+            stdext::xpar_column_extractor<xpar_full_config> extractor;
+            extractor.set_record(record, record + sizeof(record) - 1U);
+            for (const auto& field: fields)
+                extractor.add_column(field.first, field.first + std::strlen(field.first), field.second);
+            const std::size_t size = chunk_size ? chunk_size : xml.size();
+            for (std::size_t i = 0U; i < xml.size(); i += size)
+                extractor(xml.data() + i, std::min(size, xml.size() - i));
+
+            bool same = (extractor.rows() == variables.size()) && (extractor.conversion_errors() == 0U);
+            const auto& names = extractor.column(0U);
+            const auto& widths = extractor.column(1U);
+            const auto& labels = extractor.column(2U);
+            const auto& values = extractor.column(3U);
+            for (std::size_t row = 0U; same && (row != variables.size()); ++row)
+            {
+                const auto& variable = variables[row];
+                same = names.valid(row) && (text(names, row) == variable.name) && (widths.valid(row) == (variable.width != 0U)) &&
+                       (!widths.valid(row) || (widths.values_as<std::int32_t>()[row] == static_cast<std::int32_t>(variable.width))) &&
+                       (labels.valid(row) == !variable.label.empty()) && (!labels.valid(row) || (text(labels, row) == variable.label)) &&
+                       (values.valid(row) == !variable.values.empty()) &&
+                       (!values.valid(row) || (values.values_as<std::int64_t>()[row] == variable.values.front()));
+            }
+
+            check(same, "columns in chunks of " + std::to_string(size));
+        }
+    }
+
+    /// Reference for xpar_dom_index: evaluates its query subset by walking the tree from every context node.
+    template <typename _Dom>
+    std::vector<typename _Dom::node_t> walk_query(const _Dom& dom, const std::string& query)
+    {
+        using node_t = typename _Dom::node_t;
+        const auto is_name_end = [](const char c) { return (c == '/') || (c == '[') || (c == ']') || (c == '=') || (c == '@'); };
+        const auto named = [&](const node_t node, const std::string& name)
+        { return (name == "*") || std::equal(dom.name(node), dom.name_end(node), name.begin(), name.end()); };
+        const auto has_attribute = [&](const node_t node, const std::string& name, const std::string* value)
+        {
+            for (node_t child = dom.first_child(node); (child != _Dom::no_node) && (dom.kind(child) == _Dom::attribute);
+                 child = dom.next_sibling(child))
+                if (named(child, name) && (!value || std::equal(dom.value(child), dom.value_end(child), value->begin(), value->end())))
+                    return true;
+            return false;
+        };
+
+        std::vector<node_t> context(1U, 0U);
+        for (auto step = query.begin(); step != query.end();)
+        {
+            const bool descendant = (query.end() - step > 1) && (step[1] == '/');
+            step += descendant ? 2 : 1;
+            const bool attribute = *step == '@';
+            step += attribute ? 1 : 0;
+            const auto name_end = std::find_if(step, query.end(), is_name_end);
+            const std::string name(step, name_end);
+            step = name_end;
+
+            std::vector<node_t> nodes;
+            std::vector<node_t> pending;
+            for (const node_t node: context)
+                for (pending.assign(1U, node); !pending.empty();)
+                {
+                    const node_t parent = pending.back();
+                    pending.pop_back();
+                    for (node_t child = dom.first_child(parent); child != _Dom::no_node; child = dom.next_sibling(child))
+                    {
+                        if ((dom.kind(child) == (attribute ? _Dom::attribute : _Dom::element)) && named(child, name))
+                            nodes.push_back(child);
+                        if (descendant)
+                            pending.push_back(child);
+                    }
+                }
+
+            std::sort(nodes.begin(), nodes.end());
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+            while ((step != query.end()) && (*step == '['))
+            {
+                const auto predicate_end = std::find(++step, query.end(), ']');
+                const std::string predicate(step, predicate_end);
+                step = predicate_end + 1;
+                std::vector<node_t> kept;
+                if (predicate[0] == '@')
+                {
+                    const auto equal = predicate.find('=');
+                    const std::string attribute_name = predicate.substr(1U, equal - 1U);
+                    const std::string value = (equal != std::string::npos) ? predicate.substr(equal + 2U, predicate.size() - equal - 3U) : "";
+                    for (const node_t node: nodes)
+                        if (has_attribute(node, attribute_name, (equal != std::string::npos) ? &value : nullptr))
+                            kept.push_back(node);
+                }
+                else
+                {
+                    const auto position = static_cast<std::size_t>(std::stoul(predicate));
+                    for (const node_t node: nodes)
+                    {
+                        std::size_t count = 0U;
+                        for (node_t sibling = dom.first_child(dom.parent(node)); sibling != node; sibling = dom.next_sibling(sibling))
+                            count += std::binary_search(nodes.begin(), nodes.end(), sibling) ? 1U : 0U;
+                        if (count + 1U == position)
+                            kept.push_back(node);
+                    }
+                }
+
+                nodes.swap(kept);
+            }
+
+            context.swap(nodes);
+        }
+
+        return context;
+    }
+
+    /// Checks the index queries against the tree walk on nes96.
+    void check_dom_index(const std::vector<char>& xml)
+    {
+        using dom_t = stdext::xpar_dom<xpar_full_config>;
+        dom_t dom;
+        stdext::xpar_dom_builder<xpar_full_config> builder(&dom);
+        dom.reserve(xml.data(), xml.size());
+        builder.build(xml.data(), xml.size());
+        const stdext::xpar_dom_index<xpar_full_config> index(dom);
+        static const char* const queries[] = {"/codeBook",
+                                              "/codeBook/*",
+                                              "/codeBook/dataDscr/var",
+                                              "/codeBook/dataDscr/var/@name",
+                                              "/codeBook/*//catValu",
+                                              "/codeBook/stdyDscr//titl",
+                                              "/codeBook/dataDscr/var[@format='char']/labl",
+                                              "/codeBook/dataDscr/var[2]",
+                                              "//var",
+                                              "//var/@*",
+                                              "//var[3]/labl",
+                                              "//var[@dcml]",
+                                              "//var[@ID='v960010']//catValu",
+                                              "//var[@ID=\"v960002\"]/location/@width",
+                                              "//var[@format='char'][2]",
+                                              "//var[2][@format='char']",
+                                              "//catgry[2]",
+                                              "//catgryGrp/catgry[2]/catValu",
+                                              "//catgry[@missing='Y']/catValu",
+                                              "//location/@width",
+                                              "//*[@ID]",
+                                              "//*",
+                                              "//@*",
+                                              "//nothing",
+                                              "//var/nothing",
+                                              "/var",
+                                              "//var[@format='nothing']"};
+        std::size_t selected = 0U;
+        std::vector<dom_t::node_t> nodes;
+        for (const char* query: queries)
+        {
+            const bool compiled = index.select(query, query + std::strlen(query), nodes);
+            check(compiled && (nodes == walk_query(dom, query)), std::string("dom index query ") + query);
+            selected += nodes.size();
+        }
+
+        check(selected > dom.size(), "dom index queries select nodes");
+    }
+
+    void check_index_limits()
+    {
+        // path ids are 16 bits wide
+        std::string xml = "<r>";
+        for (unsigned i = 0U; i <= 0x10000U; ++i)
+            xml += "<n" + std::to_string(i) + "/>";
+        xml += "</r>";
+        using builder_t = stdext::xpar_index_builder<xpar_full_config>;
+        builder_t builder;
+        typename builder_t::xpar_t parser(&builder);
+        parser(xml.data(), xml.size());
+        check(!builder.save("xpar_index_check.tmp"), "index with more than 65536 paths refused");
+        std::remove("xpar_index_check.tmp");
+
+        // a path going past the end of the path table is refused
+        builder.clear();
+        parser.reset();
+        xml = "<r><a/></r>";
+        parser(xml.data(), xml.size());
+        check(builder.save("xpar_index_check.tmp"), "small index saved");
+        auto data = stdext::read_file("xpar_index_check.tmp");
+        std::remove("xpar_index_check.tmp");
+        stdext::xpar_index_header header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        std::uint32_t path_offset;
+        std::memcpy(&path_offset, data.data() + header.path_table_offset, sizeof(path_offset));
+        const std::uint16_t depth = 0xFFFFU;
+        std::memcpy(data.data() + header.path_table_offset + path_offset, &depth, sizeof(depth));
+        const stdext::xpar_index_view<char> view(data.data(), data.size());
+        check(view.valid() && !view.for_each_name(0U, [](const char*, const char*) {}),
+              "path past the path table refused");
+
+        // corrupted headers whose sizes would wrap around are refused
+        const auto corrupted = [&data, &header](const std::uint64_t entry_count, const std::uint64_t path_table_size)
+        {
+            auto copy = data;
+            auto changed = header;
+            changed.entry_count = entry_count;
+            changed.path_table_offset = sizeof(changed) + sizeof(stdext::xpar_index_entry) * entry_count;
+            changed.path_table_size = path_table_size;
+            std::memcpy(copy.data(), &changed, sizeof(changed));
+            return !stdext::xpar_index_view<char>(copy.data(), copy.size()).valid();
+        };
+        check(!corrupted(header.entry_count, header.path_table_size), "unchanged header accepted");
+        check(corrupted(std::uint64_t {1U} << 60U, header.path_table_size), "entry count wrapping the offset refused");
+        check(corrupted(header.entry_count, ~std::uint64_t {} - header.path_table_offset + 1U), "path table size wrapping refused");
+        check(corrupted(header.entry_count + 1U, header.path_table_size), "entries past the file refused");
+    }
+
+    /// Validates a document in chunks of every size and checks the first validation error.
+    void check_validation(const stdext::xpar_schema<char>& schema, const std::string& xml, const stdext::xpar_validation_error expected)
+    {
+        using validator_t = stdext::xpar_validator<char>;
+        for (std::size_t chunk_size = 1U; chunk_size <= xml.size(); ++chunk_size)
+        {
+            validator_t validator(&schema);
+            stdext::xpar<validator_t, xpar_full_config> parser(&validator);
+            for (std::size_t i = 0U; i < xml.size(); i += chunk_size)
+                parser(xml.data() + i, std::min(chunk_size, xml.size() - i));
+            check((parser.error() == decltype(parser.error()) {}) && (validator.error() == expected),
+                  xml + " validated in chunks of " + std::to_string(chunk_size) + ": error " +
+                      std::to_string(static_cast<int>(validator.error())));
+        }
+    }
+
+    void check_validations()
+    {
+        using stdext::xpar_simple_type;
+        using stdext::xpar_validation_error;
+        stdext::xpar_schema<char> schema;
+        schema.element("r", "(head, (item | count | amount)*)");
+        schema.element("head", "(title, day)");
+        schema.element("title", "(#PCDATA)");
+        schema.element("day", "(#PCDATA)", xpar_simple_type::date);
+        schema.element("item", "EMPTY");
+        schema.element("count", "(#PCDATA)", xpar_simple_type::integer);
+        schema.element("amount", "(#PCDATA)", xpar_simple_type::decimal);
+        schema.attribute("item", "id", true, xpar_simple_type::integer);
+        schema.attribute("item", "price", false, xpar_simple_type::decimal);
+        schema.root("r");
+        check(schema.compile(), "validation schema compiled");
+
+        const std::string head = "<head><title>t</title><day>2021-03-01</day></head>";
+        check_validation(schema, "<r xmlns='u' xmlns:p='v' xml:lang='en'>" + head + "<item id='1' price='-2.5'/><count> 42 </count>"
+                                 "<amount>.5</amount><item id='+2'></item></r>",
+                         xpar_validation_error::none);
+        check_validation(schema, "<head><title>t</title><day>2021-03-01</day></head>", xpar_validation_error::wrong_root);
+        check_validation(schema, "<r>" + head + "<title>t</title></r>", xpar_validation_error::unexpected_element);
+        check_validation(schema, "<r><head><title>t</title></head></r>", xpar_validation_error::incomplete_content);
+        check_validation(schema, "<r>" + head + "<item price='1'/></r>", xpar_validation_error::missing_attribute);
+        check_validation(schema, "<r>" + head + "<item id='1x'/></r>", xpar_validation_error::invalid_attribute);
+        check_validation(schema, "<r>" + head + "<item id='1' price='1.2.3'/></r>", xpar_validation_error::invalid_attribute);
+        check_validation(schema, "<r>" + head + "<count>4 2</count></r>", xpar_validation_error::invalid_text);
+        check_validation(schema, "<r>" + head + "<amount>1.2.3</amount></r>", xpar_validation_error::invalid_text);
+        check_validation(schema, "<r><head><title>t</title><day>2021-3-01</day></head></r>", xpar_validation_error::invalid_text);
+        check_validation(schema, "<r>" + head + "<item id='1'>x</item></r>", xpar_validation_error::unexpected_text);
+        check_validation(schema, "<r>" + head + "<other/></r>", xpar_validation_error::undeclared_element);
+
+        // only xmlns, xmlns: and xml: attributes are allowed without a declaration
+        for (const char* const name: {"xml", "xmlx", "xmlns2", "xmlnsx:p", "xml-lang"})
+            check_validation(schema, "<r " + std::string(name) + "='1'>" + head + "</r>", xpar_validation_error::undeclared_attribute);
+    }
+
+    template <typename _Value>
+    bool parsed(const std::string& text, const _Value expected)
+    {
+        _Value value {};
+        return stdext::xpar_parse(text.data(), text.data() + text.size(), value) && (value == expected);
+    }
+
+    template <typename _Value>
+    bool refused(const std::string& text)
+    {
+        _Value value {};
+        return !stdext::xpar_parse(text.data(), text.data() + text.size(), value);
+    }
+
+    /// Checks the value conversions at the limits of their types.
+    void check_values()
+    {
+        check(parsed<std::int64_t>("9223372036854775807", std::numeric_limits<std::int64_t>::max()) &&
+                  refused<std::int64_t>("9223372036854775808") &&
+                  parsed<std::int64_t>("-9223372036854775808", std::numeric_limits<std::int64_t>::min()) &&
+                  refused<std::int64_t>("-9223372036854775809"),
+              "int64 limits");
+        check(parsed<std::uint64_t>("18446744073709551615", std::numeric_limits<std::uint64_t>::max()) &&
+                  refused<std::uint64_t>("18446744073709551616") && refused<std::uint64_t>("99999999999999999999") &&
+                  refused<std::uint64_t>("184467440737095516150") && parsed<std::uint64_t>(" 000000000000000000000042 ", 42U),
+              "uint64 limits");
+        check(parsed<std::int8_t>("127", 127) && refused<std::int8_t>("128") && parsed<std::int8_t>("-128", -128) &&
+                  refused<std::int8_t>("-129") && parsed<std::uint8_t>("255", 255U) && refused<std::uint8_t>("256"),
+              "int8 limits");
+        check(parsed<unsigned>("-0", 0U) && parsed<unsigned>("+0", 0U) && refused<unsigned>("-1") && refused<unsigned>("-"),
+              "unsigned signs");
+
+        // the fast path rounds as strtod does, 2^53 + 1 is a tie going to the even 2^53
+        check(parsed<double>("9007199254740993", 9007199254740992.0) && parsed<double>("9007199254740995", 9007199254740996.0),
+              "2^53 + 1 rounded");
+        for (const char* const text: {"0.1", "1e22", "123456789e-22", "9007199254740991", "9007199254740992e10", "0.3e-5",
+                                      "1234567890123456789", "12345678901234567890e-5", "2.2250738585072014e-308"})
+            check(parsed<double>(text, std::strtod(text, nullptr)), std::string(text) + " rounded as strtod");
+
+        check(refused<double>("1e400") && refused<double>("-1e400") && refused<double>("1e-400") &&
+                  parsed<double>("4.9e-324", std::numeric_limits<double>::denorm_min()) &&
+                  parsed<double>("1.7976931348623157e308", std::numeric_limits<double>::max()) && parsed<double>("0e-400", 0.0),
+              "double range");
+
+        stdext::xpar_date_time date;
+        check(refused<stdext::xpar_date_time>("2021-02-29") &&
+                  stdext::xpar_parse("2020-02-29", "2020-02-29" + 10, date) && (date.day == 29U) &&
+                  refused<stdext::xpar_date_time>("1900-02-29") && refused<stdext::xpar_date_time>("2021-04-31") &&
+                  refused<stdext::xpar_date_time>("2021-13-01") && refused<stdext::xpar_date_time>("2021-00-10"),
+              "invalid dates");
+        check(refused<stdext::xpar_date_time>("2021-03-01T24:00:00") && refused<stdext::xpar_date_time>("2021-03-01T23:60:00") &&
+                  refused<stdext::xpar_date_time>("2021-03-01T23:59:60") && refused<stdext::xpar_date_time>("2021-03-01T23:59:59.") &&
+                  refused<stdext::xpar_date_time>("2021-03-01T23:59:59+15:00") &&
+                  stdext::xpar_parse("2021-03-01T23:59:59.5-01:30", "2021-03-01T23:59:59.5-01:30" + 27, date) &&
+                  (date.nanosecond == 500000000U) && (date.offset == -90),
+              "invalid times");
+    }
+
+    /// Collects what the transcoder forwards.
+    struct utf8_sink
+    {
+        void operator()(const char* text, const std::size_t size) { result.append(text, size); }
+
+        std::string result {};
+    };
+
+    /// Transcodes the bytes in chunks of every size and checks the UTF-8 output, the detected encoding and the failure.
+    void check_encoding(const std::string& input, const std::string& expected, const stdext::xpar_encoding encoding,
+                        const bool failed = false)
+    {
+        for (std::size_t chunk_size = 1U; chunk_size <= input.size(); ++chunk_size)
+        {
+            utf8_sink sink;
+            stdext::xpar_transcoder<utf8_sink> transcoder(&sink, true);
+            for (std::size_t i = 0U; i < input.size(); i += chunk_size)
+                transcoder(input.data() + i, std::min(chunk_size, input.size() - i));
+            transcoder.finish();
+            check((sink.result == expected) && (transcoder.encoding() == encoding) && (transcoder.failed() == failed),
+                  "encoding of " + expected + " in chunks of " + std::to_string(chunk_size) + ": " + sink.result);
+        }
+    }
+
+    void check_encodings()
+    {
+        using stdext::xpar_encoding;
+        check_encoding("\xEF\xBB\xBF<a>\xC3\xA9</a>", "<a>\xC3\xA9</a>", xpar_encoding::utf8);
+        check_encoding("<a>x</a>", "<a>x</a>", xpar_encoding::utf8);
+        check_encoding("<?xml version='1.0' encoding='ISO-8859-1'?><a>\xE9</a>", "<?xml version='1.0' encoding='ISO-8859-1'?><a>\xC3\xA9</a>",
+                       xpar_encoding::latin1);
+        check_encoding(std::string("\xFF\xFE<\0a\0>\0\xE9\0\x3D\xD8\x00\xDE<\0", 16U), "<a>\xC3\xA9\xF0\x9F\x98\x80<",
+                       xpar_encoding::utf16le);
+        check_encoding(std::string("\xFE\xFF\0<\0a\0>\xD8\x3D\xDE\x00\0<", 14U), "<a>\xF0\x9F\x98\x80<", xpar_encoding::utf16be);
+        check_encoding(std::string("<\0a\0>\0\x00\xDE\x3D\xD8", 10U), "<a>\xEF\xBF\xBD\xEF\xBF\xBD", xpar_encoding::utf16le);
+        check_encoding(std::string("\xFF\xFE<\0\x3D\xD8" "a", 7U), "<\xEF\xBF\xBD\xEF\xBF\xBD", xpar_encoding::utf16le);
+        check_encoding(std::string("\0<\0a\0>\xD8\x3D\0x", 10U), "<a>\xEF\xBF\xBDx", xpar_encoding::utf16be);
+
+        // the bytes before an invalid sequence are forwarded, a character cut by the end of the input is not
+        check_encoding("<a>\xC3\xA9x\xE2\x82</a>", "<a>\xC3\xA9x", xpar_encoding::utf8, true);
+        check_encoding("<a>\xC3\xA9x\xC0\xAF</a>", "<a>\xC3\xA9x", xpar_encoding::utf8, true);
+        check_encoding("<a>\xED\xA0\x80</a>", "<a>", xpar_encoding::utf8, true);
+        check_encoding("<a>\xF0\x9F\x98", "<a>", xpar_encoding::utf8, true);
+    }
+
+    void run_checks(const char* data_path)
+    {
+        using decoding_t = transcript_observer<xpar_decoding_config>;
+        check_transcript<decoding_t>("<r>AT&amp;T<y/>z</r>", "<r[AT&T]<y/y[z]/r");
+        check_transcript<decoding_t>("<r>AT&T<y/>z</r>", "<r[AT&T]<y/y[z]/r");
+        check_transcript<decoding_t>("<r>&lt;&#x41;&#66;&bogus;</r>", "<r[<AB&bogus;]/r");
+        check_transcript<transcript_observer<xpar_full_config>>("<r><a b c='1'>t</a></r>", "<r<a@b=@c=1[t]/a/r");
+        for (const auto& item: {std::make_pair("<r>a<![CDATA[x<y]]]>b</r>", "<r[a]{x<y]}[b]/r"),
+                                std::make_pair("<r><![CDATA[]]]]]><![CDATA[]]></r>", "<r{]]]}{}/r"),
+                                std::make_pair("<r><![INCLUDE[x]]>y</r>", "<r[y]/r"), std::make_pair("<r><![CDAT>y</r>", "<r[y]/r")})
+        {
+            check_transcript<transcript_observer<xpar_full_config>>(item.first, item.second);
+            check_transcript<transcript_observer<xpar_full_config, stdext::xpar_dfa>>(item.first, item.second);
+        }
+
+        // the depth limit stops both engines, xpar_dfa recovers from the other errors when asked
+        check_transcript<transcript_observer<xpar_recovering_config>>("<r><a><b><c><d>x</d></c></b></a></r>", "<r<a<b!8");
+        using recovering_dfa_t = transcript_observer<xpar_recovering_config, stdext::xpar_dfa>;
+        check_transcript<recovering_dfa_t>("<r><a><b><c><d>x</d></c></b></a></r>", "<r<a<b!7");
+        check_transcript<recovering_dfa_t>("<r><a x=1>t</a><b>u</b></r>", "<r<a@x=!2/a<b[u]/b/r");
+        check_transcript<recovering_dfa_t>("<r><toolongname a='1'>t</toolongname><b/></r>", "<r!4!1<b/b/r");
+        check_transcript<recovering_dfa_t>("<r><a>t</b><c/></r>", "<r<a[t]!1<c/c/r");
+        check_transcript<recovering_dfa_t>("<r>a<<b/>c</r>", "<r[a]!2<b/b[c]/r");
+        check_transcript<transcript_observer<xpar_full_config, stdext::xpar_dfa>>("<r><a x=1>t</a></r>", "<r<a@x=!2");
+
+        using namespace_t = namespace_transcript_observer<xpar_full_config>;
+        check_transcript<namespace_t>("<r xmlns='u' xmlns:p='v'><p:a p:x='1' y='2'/><b xmlns=''/><q:c/></r>",
+                                      "<3:r@2:xmlns=u@2:p=v<4:a@4:x=1@0:y=2/4:a<0:b@2:xmlns=/0:b<0:q:c/0:q:c/3:r");
+        check_transcript<namespace_transcript_observer<xpar_recovering_config>>("<r><toolongname a='1'>t<b/>", "<0:r!4[t]<0:b/0:b");
+
+        // the attributes of a split tag over the limit are dropped up to the tag end, an unsplit tag is not copied
+        check_transcript<transcript_observer<xpar_lazy_config>>("<r><a x='1' y=\"2\">t</a><b z='3'/></r>", "<r<a@x=1@y=2[t]/a<b@z=3/b/r");
+        using lazy_recovering_t = transcript_observer<xpar_lazy_recovering_config>;
+        for (const std::size_t chunk_size: {7U, 17U})
+            check(transcript<lazy_recovering_t>("<r><a xyzwvut='1' y='2'>t</a><b y='1'/></r>", chunk_size) == "<r!6<a[t]/a<b@y=1/b/r",
+                  "lazy split attributes over the limit in chunks of " + std::to_string(chunk_size));
+        for (const std::size_t chunk_size: {7U, 17U, 18U})
+            check(transcript<lazy_recovering_t>("<r><a xyzwvut='1'/>t</r>", chunk_size) == "<r!6<a/a[t]/r",
+                  "lazy split empty tag over the limit in chunks of " + std::to_string(chunk_size));
+        check(transcript<lazy_recovering_t>("<r><a x='12345678'>t</a></r>", 64U) == "<r<a@x=12345678[t]/a/r", "lazy unsplit attributes");
+
+        // the attributes over max_attributes are dropped without writing past the tag buffer
+        const std::string x(500U, 'a'), y(500U, 'b'), z(500U, 'c');
+        check_transcript<start_tag_transcript_observer<xpar_start_tag_recovering_config>>(
+            "<r><a " + std::string(31U, 'x') + "='" + x + "' " + std::string(31U, 'y') + "='" + y + "' zz='" + z + "' w>t</a><b/></r>",
+            "<r!7!7!7<a@" + std::string(31U, 'x') + '=' + x + "/a<b/b/r");
+
+        check_checkpoints<transcript_observer<xpar_full_config>>("<a x='1'><b>text</b><!-- c --><![CDATA[d]]><e/></a>");
+        const std::string long_name(280U, 'n');
+        check_checkpoints<transcript_observer<xpar_long_name_config>>("<a><" + long_name + ">t</" + long_name + "></a>");
+
+        check_transcript<transcript_observer<xpar_trimming_config>>("<r> AT&T <y/> z&amp; </r>", "<r[AT&T]<y/y[z&]/r");
+
+        const auto nes96 = stdext::read_file(stdext::xml_files(data_path)[1U]);
+        check_index<xpar_full_config>(nes96, "index");
+        check_index<xpar_trusted_config>(nes96, "trusted index");
+        check_index<xpar_lazy_config>(nes96, "lazy index");
+        check_index_limits();
+        check_filter(nes96);
+        check_binding(nes96);
+        check_columns(nes96);
+        check_dom_index(nes96);
+        check_validations();
+        check_values();
+        check_encodings();
+    }
+
+    template <typename _Observer>
+    class test: public stdext::test<_Observer>
+    {
+    public:
+        using base_t = stdext::test<_Observer>;
+        using typename base_t::xml_data_t;
+
+        test(const char* name, const char* data_path): base_t(name, data_path) {}
+
+    private:
+        void execute(const xml_data_t& xml_data) override
+        {
+            typename _Observer::xpar_t parser(&this->observer());
+            parser(xml_data.data(), xml_data.size());
+        }
+    };
+}
+
+int main(const int /*argc*/, const char* const argv[])
+{
+    using namespace xpar_testing;
+    test<counting_observer<xpar_full_config>> full("xpar full", argv[1U]);
+    test<counting_observer<xpar_trusted_config>> trusted("xpar trusted", argv[1U]);
+    test<attribute_names_observer<xpar_full_config>> attribute_names("xpar without attribute values", argv[1U]);
+    test<counting_observer<xpar_computed_goto_config>> computed_goto("xpar computed goto", argv[1U]);
+    test<counting_observer<xpar_full_config, stdext::xpar_dfa>> dfa("xpar dfa", argv[1U]);
+    test<start_tag_observer<xpar_start_tag_config>> start_tag("xpar start tag", argv[1U]);
+    test<selecting_observer<xpar_full_config>> selecting("xpar selected attributes", argv[1U]);
+    test<lazy_observer<xpar_lazy_config>> lazy("xpar lazy attributes", argv[1U]);
+    test<path_observer<xpar_full_config>> path("xpar path filter", argv[1U]);
+    test<query_observer<xpar_full_config>> query("xpar query set", argv[1U]);
+    test<dom_observer<xpar_full_config>> dom("xpar dom", argv[1U]);
+    test<validating_observer<xpar_full_config>> validating("xpar validating", argv[1U]);
+    test<typed_observer<xpar_full_config>> typed("xpar typed values", argv[1U]);
+    test<binding_observer<xpar_full_config>> binding("xpar binding", argv[1U]);
+    test<columns_observer<xpar_full_config>> columns("xpar columns", argv[1U]);
+    test<index_observer<xpar_full_config>> index("xpar dom index", argv[1U]);
+    test<index_builder_observer<xpar_trusted_config>> index_builder("xpar offset index", argv[1U]);
+    test<filter_observer<xpar_full_config>> filter("xpar filter, 256 byte chunks", argv[1U]);
+    test<copy_observer<xpar_full_config>> copy("memcpy, 256 byte chunks", argv[1U]);
+    test<namespace_observer<xpar_full_config>> namespaces("xpar namespaces", argv[1U]);
+    full.run();
+    trusted.run();
+    attribute_names.run();
+    computed_goto.run();
+    dfa.run();
+    start_tag.run();
+    selecting.run();
+    lazy.run();
+    path.run();
+    query.run();
+    dom.run();
+    validating.run();
+    typed.run();
+    binding.run();
+    columns.run();
+    index.run();
+    index_builder.run();
+    filter.run();
+    copy.run();
+    namespaces.run();
+    run_checks(argv[1U]);
+    std::cout << "check failures: " << failure_count << '\n';
+    return failure_count == 0U ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "tools.hpp"
+#include <xpar.hpp>
+
+namespace xpar_testing
+{
+    template <typename _Char>
+    struct xpar_wide_config
+    {
+        using char_t = _Char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16
+        };
+    };
+
+    /// Positions computed on request, which counts the lines with the SSE2 overloads for char16_t and char32_t.
+    template <typename _Char>
+    struct xpar_wide_untracked_config
+    {
+        using char_t = _Char;
+
+        enum const_t
+        {
+            try_continue_on_error = 0,
+            max_name_length = 32,
+            max_value_length = 512,
+            max_stack_size = 16,
+            track_position = 0
+        };
+    };
+
+    /// Decodes UTF-8 into UTF-16 or UTF-32, malformed sequences become U+FFFD.
+    template <typename _Char>
+    std::vector<_Char> widen(const std::vector<char>& bytes)
+    {
+        std::vector<_Char> result;
+        result.reserve(bytes.size());
+        for (std::size_t i = 0U; i < bytes.size();)
+        {
+            const unsigned char lead = static_cast<unsigned char>(bytes[i++]);
+            const std::size_t length = (lead < 0x80U) ? 0U : (lead >= 0xf0U) ? 3U : (lead >= 0xe0U) ? 2U : (lead >= 0xc0U) ? 1U : 4U;
+            char32_t code = (length == 0U) ? lead : (length == 4U) ? 0xfffdU : (lead & (0x3fU >> length));
+            for (std::size_t j = 0U; (j < length) && (length < 4U); ++j)
+            {
+                const unsigned char next = (i < bytes.size()) ? static_cast<unsigned char>(bytes[i]) : 0U;
+                if ((next & 0xc0U) != 0x80U)
+                {
+                    code = 0xfffdU;
+                    break;
+                }
+
+                code = (code << 6U) | (next & 0x3fU);
+                ++i;
+            }
+
+            if ((sizeof(_Char) == 2U) && (code >= 0x10000U))
+            {
+                result.push_back(static_cast<_Char>(0xd800U + ((code - 0x10000U) >> 10U)));
+                code = 0xdc00U + (code & 0x3ffU);
+            }
+
+            result.push_back(static_cast<_Char>(code));
+        }
+
+        return result;
+    }
+
+    /// The UTF-8 bytes as they are, for the narrow parse the wide ones are compared with.
+    template <>
+    inline std::vector<char> widen<char>(const std::vector<char>& bytes)
+    {
+        return bytes;
+    }
+
+    template <typename _Char, typename _Config = xpar_wide_config<_Char>>
+    class counting_observer: public stdext::counting_observer
+    {
+    public:
+        using xpar_t = stdext::xpar<counting_observer, _Config>;
+        using char_t = typename xpar_t::char_t;
+
+        void on_element_begin(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) {}
+        void on_element_end(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++element_count; }
+        void on_attribute(xpar_t& /*parser*/, const char_t* /*name*/, const char_t* /*name_end*/) { ++attribute_count; }
+        void on_attribute_value(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) {}
+        void on_data(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++data_count; }
+        void on_comment(xpar_t& /*parser*/, const char_t* /*text*/, const char_t* /*text_end*/, const bool /*partial*/) { ++comment_count; }
+        void on_error(xpar_t& parser, bool& /*try_continue*/)
+        {
+            std::cout << parser.line() << ':' << parser.column() << " error" << std::endl;
+            ++error_count;
+        }
+    };
+
+    /// Widens the file before the timed run so only the parsing is measured; lines() and totals() sum the line counts and the
+    /// event counts of the files.
+    template <typename _Char, typename _Config = xpar_wide_config<_Char>>
+    class test: public stdext::test<counting_observer<_Char, _Config>>
+    {
+    public:
+        using observer_t = counting_observer<_Char, _Config>;
+        using base_t = stdext::test<observer_t>;
+        using typename base_t::xml_data_t;
+
+        test(const char* name, const char* data_path): base_t(name, data_path) {}
+
+        std::uint64_t lines() const noexcept { return lines_; }
+        const stdext::counting_observer& totals() const noexcept { return totals_; }
+
+    private:
+        void prepare(const xml_data_t& xml_data) override { wide_data_ = widen<_Char>(xml_data); }
+
+        void execute(const xml_data_t& /*xml_data*/) override
+        {
+            typename observer_t::xpar_t parser(&this->observer());
+            parser(wide_data_.data(), wide_data_.size());
+            lines_ += parser.line();
+            totals_.element_count += this->observer().element_count;
+            totals_.attribute_count += this->observer().attribute_count;
+            totals_.data_count += this->observer().data_count;
+            totals_.error_count += this->observer().error_count;
+        }
+
+        std::vector<_Char> wide_data_;
+        std::uint64_t lines_ {};
+        stdext::counting_observer totals_ {};
+    };
+
+    bool same_counts(const stdext::counting_observer& left, const stdext::counting_observer& right) noexcept
+    {
+        return (left.element_count == right.element_count) && (left.attribute_count == right.attribute_count) &&
+               (left.data_count == right.data_count) && (left.error_count == right.error_count);
+    }
+}
+
+int main(const int /*argc*/, const char* const argv[])
+{
+    using namespace xpar_testing;
+    test<char> utf8("xpar char", argv[1U]);
+    test<char16_t> utf16("xpar char16_t", argv[1U]);
+    test<char32_t> utf32("xpar char32_t", argv[1U]);
+    test<char16_t, xpar_wide_untracked_config<char16_t>> utf16_untracked("xpar char16_t untracked", argv[1U]);
+    test<char32_t, xpar_wide_untracked_config<char32_t>> utf32_untracked("xpar char32_t untracked", argv[1U]);
+    utf8.run();
+    utf16.run();
+    utf32.run();
+    utf16_untracked.run();
+    utf32_untracked.run();
+
+    // the wide parses see the events of the narrow one, the lines counted on request match the tracked ones
+    const bool same_events = same_counts(utf16.totals(), utf8.totals()) && same_counts(utf32.totals(), utf8.totals()) &&
+                             same_counts(utf16_untracked.totals(), utf8.totals()) && same_counts(utf32_untracked.totals(), utf8.totals());
+    const bool same_lines = (utf16.lines() == utf8.lines()) && (utf32.lines() == utf8.lines()) &&
+                            (utf16_untracked.lines() == utf16.lines()) && (utf32_untracked.lines() == utf32.lines());
+    std::cout << "wide event counts " << (same_events ? "match" : "differ") << '\n';
+    std::cout << "untracked line count " << (same_lines ? "matches" : "differs") << '\n';
+    return same_events && same_lines ? 0 : 1;
+}
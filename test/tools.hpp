@@ -91,6 +91,7 @@ namespace stdext
         using file_path_vector_t = std::vector<std::string>;
         using duration_t = std::chrono::duration<double>;
 
+        virtual void prepare(const xml_data_t& /*xml_data*/) {}
         virtual void execute(const xml_data_t& xml_data) = 0;
 
         duration_t parse(const std::string& file_path)
@@ -100,6 +101,7 @@ namespace stdext
             cout << "test begins: " << file_path << '\n';
             observer_.clear();
             xml_data_ = stdext::read_file(file_path);
+            prepare(xml_data_);
             const auto start_time = high_resolution_clock::now();
             execute(xml_data_);
             const duration_t diff = high_resolution_clock::now() - start_time;